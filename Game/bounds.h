@@ -0,0 +1,20 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <string>
+
+// Bounds-checking policy of the engine, fixed at compile time. A checked build
+// (`make CHECKED=1`, which defines MAZE_CHECKED) validates every grid access,
+// stage lookup and move target and throws on a violation. The default unchecked
+// build relies on invariants validated once while the map is loaded instead:
+// the '+' border around the grid, a stage for every column that is not wall and
+// a player on the map (the loaders throw otherwise).
+#ifdef MAZE_CHECKED
+inline constexpr bool CHECKED_BUILD = true;
+#else
+inline constexpr bool CHECKED_BUILD = false;
+#endif
+
+[[noreturn]] void throwOutOfBounds(const std::string &what); // Out of line so the checks stay small enough to inline
+
+#endif // BOUNDS_H
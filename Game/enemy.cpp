@@ -1,65 +1,248 @@
 #include "enemy.h"
+#include <algorithm>
 #include <stdexcept>
 
-using std::string;
 using std::vector;
 
-Enemy::Enemy(int h, int w, string enemy_type)
-    : type(enemy_type), pos{h, w}
+void Enemies::clear()
 {
-    if (type == "vertical")
+    cell.clear();
+    step.clear();
+    behaviour.clear();
+    parked.clear();
+    synced.clear();
+    stepped.clear();
+    by_stage.clear();
+    lazy_mode = false;
+    steps = 0;
+    first_active = -1;
+    last_active = -1;
+}
+
+void Enemies::add(const Grid &map, int h, int w, EnemyBehaviour type)
+{
+    stride = map.rowStride();
+    cell.push_back(static_cast<uint32_t>(map.index(h, w)));
+    step.push_back(stride); // Vertical enemies start moving down
+    behaviour.push_back(type);
+    parked.push_back(0);
+    synced.push_back(steps);
+}
+
+char Enemies::getDirection(size_t i) const
+{
+    return step[i] > 0 ? 'v' : '^';
+}
+
+void Enemies::setState(size_t i, int h, int w, char direction)
+{
+    if (direction != 'v' && direction != '^')
     {
-        direction = 'v'; // Set the direction to down for vertical enemies
+        throw std::runtime_error("Invalid direction for vertical enemy"); // Error if direction is invalid
     }
+    cell[i] = static_cast<uint32_t>(static_cast<size_t>(h + 1) * stride + (w + 1));
+    step[i] = (direction == 'v') ? stride : -stride;
 }
 
-void Enemy::move(vector<vector<char>> &map, Player &player, const vector<int> &stage_indices)
+void Enemies::update(Grid &map, Player &player, const MapIndex &index, vector<Undo> *journal)
 {
-    if (type == "vertical")
+    // Lazy mode walks the list of stepped enemies, otherwise every index in turn
+    if (lazy_mode)
+        refreshActive(map, player, index);
+    const uint32_t *ids = lazy_mode ? stepped.data() : nullptr;
+    const uint32_t count = static_cast<uint32_t>(lazy_mode ? stepped.size() : cell.size());
+
+    // Every behaviour so far is a patrol along step[i]; the '+' border keeps each target addressable
+    size_t player_cell = map.index(player.getH(), player.getW());
+    for (uint32_t k{0}; k < count; k++)
     {
-        int new_w, new_h; // New position variables
-        if (direction == 'v')
-        {
-            new_w = pos[1];     // Keep the same column
-            new_h = pos[0] + 1; // Move down
-        }
-        else if (direction == '^')
+        uint32_t i = ids ? ids[k] : k;
+        uint32_t from = cell[i];
+        uint32_t to = from + step[i];
+        uint8_t target_flags = map.flagsAt(to);
+        if (target_flags & TILE_WALL)
         {
-            new_w = pos[1];     // Keep the same column
-            new_h = pos[0] - 1; // Move down
+            if (journal)
+                journal->push_back({i, from, step[i]});
+            step[i] = -step[i]; // Turn around
+            continue;
         }
-        else
+        if (!(target_flags & TILE_EMPTY))
         {
-            throw std::runtime_error("Invalid direction for vertical enemy"); // Error if direction is invalid
+            if (to != player_cell)
+                continue; // Blocked by an item, a trap or another enemy
+            player.respawn(map, index);
+            player_cell = map.index(player.getH(), player.getW());
         }
-        if (map[new_h][new_w] == ' ') // Check if the target position is empty
+        if (journal)
+            journal->push_back({i, from, step[i]});
+        map.setCell(from, ' '); // Clear the old position
+        map.setCell(to, 'X');   // Move to the new position
+        cell[i] = to;
+    }
+    steps++;
+}
+
+void Enemies::setLazy(bool on, Grid &map, const MapIndex &index)
+{
+    sync(map); // Nothing to do unless lazy stepping was on already
+    lazy_mode = on;
+    for (auto &members : by_stage)
+        members.clear(); // Keeps the storage: every loadState turns lazy stepping off and on again
+    if (on)
+    {
+        by_stage.resize(index.stageCount());
+        for (size_t i{0}; i < cell.size(); i++)
         {
-            map[pos[0]][pos[1]] = ' '; // Clear the old position
-            map[new_h][new_w] = 'X';   // Move to the new position
-            pos[0] = new_h;            // Update the enemy's position
-            pos[1] = new_w;
+            by_stage[index.stageOf(getW(i))].push_back(static_cast<uint32_t>(i));
         }
-        else if (map[new_h][new_w] == '+') // Check if the target position is an enemy
+    }
+    resetActivity(); // The next update parks whatever is outside the active stages
+}
+
+void Enemies::resetActivity()
+{
+    std::fill(parked.begin(), parked.end(), 0);
+    std::fill(synced.begin(), synced.end(), steps);
+    first_active = -1;
+    last_active = -1;
+    rebuildStepped();
+}
+
+void Enemies::restore(const Enemies &start)
+{
+    // Same map, so the per-stage lists stay valid and the copies reuse the storage
+    cell = start.cell;
+    step = start.step;
+    behaviour = start.behaviour;
+    steps = 0;
+    resetActivity();
+}
+
+void Enemies::sync(Grid &map)
+{
+    if (!lazy_mode)
+        return;
+    for (size_t i{0}; i < cell.size(); i++)
+    {
+        if (parked[i])
+            catchUp(map, i); // Stays parked, now with an exact cell
+    }
+}
+
+void Enemies::rebuildStepped()
+{
+    stepped.clear();
+    for (size_t i{0}; i < cell.size(); i++)
+    {
+        if (!parked[i])
+            stepped.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+void Enemies::refreshActive(Grid &map, const Player &player, const MapIndex &index)
+{
+    // Active: the player's stage, its neighbours, and every stage the vision box can reach by the
+    // end of this cycle (5 cells past the player plus the move it may make)
+    const int REACH = 6;
+    int p_w = player.getW();
+    int stage = index.stageOf(p_w);
+    int first = std::max(0, std::min(stage - 1, index.stageOf(std::max(index.stageStart(0), p_w - REACH))));
+    int last = std::min(index.stageCount() - 1, std::max(stage + 1, index.stageOf(std::min(map.width() - 1, p_w + REACH))));
+    if (first == first_active && last == last_active)
+        return;
+
+    bool initial = first_active < 0;
+    for (int s = first; s <= last; s++)
+    {
+        if (!initial && s >= first_active && s <= last_active)
+            continue;
+        for (uint32_t i : by_stage[s])
         {
-            if (direction == 'v')
-            {
-                direction = '^'; // Change direction to up
-            }
-            else if (direction == '^')
+            if (parked[i])
             {
-                direction = 'v'; // Change direction to down
+                catchUp(map, i);
+                parked[i] = 0;
             }
         }
-        else if (player.getW() == new_w && player.getH() == new_h) // Check if the enemy hits the player
+    }
+    int leaving_first = initial ? 0 : first_active;
+    int leaving_last = initial ? index.stageCount() - 1 : last_active;
+    for (int s = leaving_first; s <= leaving_last; s++)
+    {
+        if (s >= first && s <= last)
+            continue;
+        for (uint32_t i : by_stage[s])
         {
-            player.respawn(map, stage_indices);
-            map.at(pos[0]).at(pos[1]) = ' '; // Clear the old position
-            map.at(new_h).at(new_w) = 'X';   // Move to the new position
-            pos[0] = new_h;                  // Update the enemy's position
-            pos[1] = new_w;
+            if (!parked[i] && canPark(map, i))
+            {
+                parked[i] = 1;
+                synced[i] = steps;
+            }
         }
-        else
+    }
+    first_active = first;
+    last_active = last;
+    rebuildStepped();
+}
+
+bool Enemies::canPark(const Grid &map, size_t i) const
+{
+    // Another enemy next to the segment could move into it, so only segments closed by static tiles qualify
+    uint32_t top = cell[i];
+    while (map.cell(top - stride) == ' ')
+        top -= stride;
+    uint32_t bottom = cell[i];
+    while (map.cell(bottom + stride) == ' ')
+        bottom += stride;
+    return map.cell(top - stride) != 'X' && map.cell(bottom + stride) != 'X';
+}
+
+void Enemies::catchUp(Grid &map, size_t i)
+{
+    uint32_t n = steps - synced[i];
+    synced[i] = steps;
+    if (n == 0)
+        return;
+
+    // Segment of the patrol: rows top..top + length (in cells), closed by a blocker at each end
+    uint32_t from = cell[i];
+    uint32_t top = from;
+    while (map.cell(top - stride) == ' ')
+        top -= stride;
+    uint32_t bottom = from;
+    while (map.cell(bottom + stride) == ' ')
+        bottom += stride;
+    uint32_t length = (bottom - top) / stride;
+    bool top_wall = map.flagsAt(top - stride) & TILE_WALL;
+    bool bottom_wall = map.flagsAt(bottom + stride) & TILE_WALL;
+
+    uint32_t p = (from - top) / stride;
+    bool down = step[i] > 0;
+    if (top_wall && bottom_wall)
+        n %= 2 * length + 2; // Down the segment, turn, up the segment, turn
+    while (n > 0)
+    {
+        uint32_t distance = down ? length - p : p;
+        if (n <= distance)
         {
+            p = down ? p + n : p - n;
+            break;
         }
+        n -= distance;
+        p = down ? length : 0;
+        if (!(down ? bottom_wall : top_wall))
+            break; // Walked up to a blocker that is no wall: it stalls there for good
+        n--;       // Turning around takes one update
+        down = !down;
     }
-}
\ No newline at end of file
+
+    uint32_t to = top + p * stride;
+    if (to != from)
+    {
+        map.setCell(from, ' ');
+        map.setCell(to, 'X');
+    }
+    cell[i] = to;
+    step[i] = down ? stride : -stride;
+}
@@ -1,20 +1,80 @@
 #ifndef ENEMY_H
 #define ENEMY_H
 
-#include <string>
+#include <cstdint>
 #include <vector>
+#include "grid.h"
+#include "map_index.h"
 #include "player.h"
 
-class Enemy
+enum class EnemyBehaviour : uint8_t
 {
-    std::string type;
-    int pos[2]; // Position of the enemy (h, w)
-    char direction{'>'};
+    Vertical, // Patrols its column, bouncing off walls
+};
+
+// Structure-of-arrays store of every enemy on the map. Positions are padded grid
+// indices and directions are index offsets, so one update is a single pass over
+// flat arrays: read the target's flags, then move, bounce or stall.
+//
+// With lazy stepping on, only enemies near the player are stepped. An enemy that
+// leaves the active stages and patrols a segment of ' ' cells closed by static
+// tiles is parked. Nothing can change that segment while the player is away, so
+// when its stage becomes active again the enemy is caught up in closed form:
+// between two walls it cycles with period 2L + 2 (L moves each way plus one turn
+// at each end), and towards any other blocker it walks up to it and stalls.
+class Enemies
+{
+    std::vector<uint32_t> cell;              // Padded grid index of each enemy
+    std::vector<int32_t> step;               // Index offset of the next move (+stride down, -stride up)
+    std::vector<EnemyBehaviour> behaviour;   // Movement rule each enemy was created with
+    int stride{0};                           // Row stride of the grid the indices point into
+
+    // Lazy stepping
+    bool lazy_mode{false};
+    uint32_t steps{0};                       // Updates applied so far
+    std::vector<uint8_t> parked;             // 1 if the enemy is not stepped (its grid cell may be stale)
+    std::vector<uint32_t> synced;            // Update count a parked enemy's state belongs to
+    std::vector<uint32_t> stepped;           // Enemies stepped by update() in lazy mode, ascending
+    std::vector<std::vector<uint32_t>> by_stage; // Enemies of every stage, ascending
+    int first_active{-1};                    // Active stage range, [-1, -1] before the first update
+    int last_active{-1};
+
+    void refreshActive(Grid &, const Player &, const MapIndex &); // Parks and wakes enemies when the active stages change
+    bool canPark(const Grid &, size_t i) const;                    // Segment closed by static tiles, no other enemy in it
+    void catchUp(Grid &, size_t i);                                // Moves a parked enemy to its state after `steps` updates
+    void rebuildStepped();
 
-private:
 public:
-    Enemy(int, int, std::string);                                                    // Constructor
-    void move(std::vector<std::vector<char>> &, Player &, const std::vector<int> &); // Move the enemy in the map
+    struct Undo // State of one enemy before an update changed it
+    {
+        uint32_t enemy;
+        uint32_t cell;
+        int32_t step;
+    };
+
+    void clear();                                        // Removes every enemy
+    void add(const Grid &, int h, int w, EnemyBehaviour); // Adds an enemy at (h, w) with its initial direction
+    size_t size() const { return cell.size(); }
+    int getH(size_t i) const { return static_cast<int>(cell[i] / stride) - 1; } // Get enemy i's h coordinate
+    int getW(size_t i) const { return static_cast<int>(cell[i] % stride) - 1; } // Get enemy i's w coordinate
+    char getDirection(size_t i) const;                                         // Get enemy i's direction character
+    void setState(size_t i, int h, int w, char direction);                     // Restore position and direction (used by Game::loadState)
+    void undo(const Undo &entry) // Puts an enemy back into a journaled state
+    {
+        cell[entry.enemy] = entry.cell;
+        step[entry.enemy] = entry.step;
+    }
+
+    // Moves every enemy one step. An enemy walking into the player respawns it; the player's
+    // cell is computed once and only refreshed after such a respawn. Enemies that change are
+    // appended to journal when it is given (lazy stepping must be off while journaling).
+    void update(Grid &, Player &, const MapIndex &, std::vector<Undo> *journal);
+
+    void setLazy(bool on, Grid &, const MapIndex &); // Turns lazy stepping on or off; either way every enemy is exact afterwards
+    bool isLazy() const { return lazy_mode; }
+    void sync(Grid &);                               // Catches parked enemies up, so the grid and getH/getW are exact
+    void resetActivity();                            // Forgets parking after every position was set (loadState)
+    void restore(const Enemies &start);              // Copies positions and directions of the same map's start (Game::reset)
 };
 
-#endif // ENEMY_H
\ No newline at end of file
+#endif // ENEMY_H
@@ -1,13 +1,15 @@
 #include "game.h"
+#include "map_file.h"
+#include "renderer.h"
+#include "tracer.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <chrono>
-#include <thread>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+#include <thread>
 
-using std::cerr;
 using std::cout;
 using std::endl;
 using std::getline;
@@ -15,12 +17,23 @@ using std::ifstream;
 using std::isdigit;
 using std::string;
 using std::stringstream;
-using std::unordered_map;
 using std::vector;
 
-Game::Game(const string &path_to_map, int visual)
-    : path_to_map(path_to_map), visual(visual)
+Game::Game(const string &path_to_map, int visual, bool quiet)
+    : path_to_map(path_to_map), visual(visual), quiet(quiet)
+{
+}
+
+Game::Game(std::shared_ptr<const GameTemplate> map_template, int visual, bool quiet)
+    : path_to_map(map_template->path), visual(visual), quiet(quiet), pristine(std::move(map_template))
+{
+}
+
+std::shared_ptr<const GameTemplate> Game::loadTemplate(const string &path)
 {
+    Game game(path, 0, true);
+    game.initGame();
+    return game.pristine;
 }
 
 vector<int> Game::getStageIndices(const string &line)
@@ -28,7 +41,8 @@ vector<int> Game::getStageIndices(const string &line)
     vector<int> temp_stage_indices; // Vector to store stage indices
     for (size_t i{0}; i < line.size(); i++)
     {
-        if (line.at(i) != ' ' && isdigit(line.at(i))) // Check for digits
+        // A stage marker is a run of digits ("1", "12", "305"); the stage starts at its first digit
+        if (isdigit(static_cast<unsigned char>(line[i])) && (i == 0 || !isdigit(static_cast<unsigned char>(line[i - 1]))))
         {
             temp_stage_indices.push_back(i); // Store the stage indices
         }
@@ -37,28 +51,21 @@ vector<int> Game::getStageIndices(const string &line)
     return temp_stage_indices;
 }
 
-int Game::getStage(int w)
+void Game::getVision(Vision &vision) const
 {
-    // Get the stage number based on coordinates
-    for (size_t i{0}; i < stage_indices.size(); i++)
-    {
-        if (w >= stage_indices.at(i) && (i + 1 >= stage_indices.size() || w < stage_indices.at(i + 1)))
-        {
-            return i; // Return the stage number
-        }
-    }
-    throw std::runtime_error("Invalid stage index: " + std::to_string(w)); // Error if no valid stage found
-}
-
-vector<vector<char>> Game::getVision()
-{
-    vector<vector<char>> vision;
+    TraceScope span("Game::getVision");
     int p_w = player.getW();
     int p_h = player.getH();
     char direction = player.getDirection();
 
     int min_row, max_row, min_col, max_col;
 
+    vision.rows = 0;
+    vision.cols = 0;
+    vision.player_row = -1;
+    vision.player_col = -1;
+    vision.facing = direction;
+
     // Compute the vision box (6 cells deep including player's cell, 5 cells wide)
     switch (direction)
     {
@@ -87,139 +94,457 @@ vector<vector<char>> Game::getVision()
         max_row = p_h + 2;
         break;
     default:
-        return vision; // return an empty vector if no valid direction
+        return; // leave the vision empty if no valid direction
     }
 
     // Ensure our bounds don't exceed the map's limits.
     min_row = std::max(min_row, 0);
     min_col = std::max(min_col, 0);
-    max_row = std::min(max_row, static_cast<int>(map.size()) - 1);
-    if (!map.empty())
-        max_col = std::min(max_col, static_cast<int>(map[0].size()) - 1);
+    max_row = std::min(max_row, map.height() - 1);
+    max_col = std::min(max_col, map.width() - 1);
+    if (min_row > max_row || min_col > max_col)
+        return;
 
-    // Create the vision vector by copying the visible part of the map.
-    for (int i = min_row; i <= max_row; ++i)
+    // Copy the visible part of the map into the inline buffer.
+    vision.rows = max_row - min_row + 1;
+    vision.cols = max_col - min_col + 1;
+    for (int i = 0; i < vision.rows; ++i)
     {
-        vector<char> row;
-        for (int j = min_col; j <= max_col; ++j)
-        {
-            row.push_back(map[i][j]);
-        }
-        vision.push_back(row);
+        const char *row = map.row(min_row + i) + min_col;
+        std::copy(row, row + vision.cols, &vision.cells[i * Vision::MAX_DIM]);
     }
-    return vision;
+    vision.player_row = p_h - min_row;
+    vision.player_col = p_w - min_col;
 }
 
-void Game::createMap(const vector<string> &map_lines)
+void Game::createRow(int h, const string &line)
 {
-    // Create the map from the given lines
-    cout << "Creating map..." << endl;
-
-    for (size_t h{1}; h < map_lines.size(); h++)
+    // Store one map row and register the entities on it
+    map.appendRow(line.data());
+    for (int w{0}; w < static_cast<int>(line.size()); w++)
     {
-        for (size_t w{0}; w < map_lines.at(h).size(); w++)
+        char tile = line[w];
+        if (tile == 'v' || tile == '>' || tile == '<' || tile == '^')
         {
-            this->map.at(h - 1).at(w) = map_lines.at(h).at(w); // Fill the map with characters
-            if (map_lines.at(h).at(w) == 'v' || map_lines.at(h).at(w) == '>' || map_lines.at(h).at(w) == '<' || map_lines.at(h).at(w) == '^')
-            {
-                // found a player character
-                player = Player(h - 1, w, map_lines.at(h).at(w)); // Ensure Player class has a matching constructor
-            }
-            else if (map_lines.at(h).at(w) == '0') // Check for end position
-            {
-                // found a food entity
-                int temp_stage = getStage(w); // Get the stage number
-                // cout << "stage of: " << w << " is : " << temp_stage << endl;
-
-                if (food_count.find(temp_stage) != food_count.end()) // Check if the key exists in the map
-                {
-                    food_count[temp_stage]++; // Increment the key value
-                }
-                else
-                {
-                    food_count[temp_stage] = 1; // Initialize the key value
-                }
-            }
-            else if (map_lines.at(h).at(w) == 'A' || map_lines.at(h).at(w) == 'B') // Check for food entity
-            {
-                stage_flag_picked[getStage(w)] = false; // Mark the stage as picked
-                stage_flag_placed[getStage(w)] = false; // Mark the stage as placed
-            }
-            else if (map_lines.at(h).at(w) == 'X')
-            {
-                enemies.push_back(Enemy(h - 1, w, "vertical")); // Create an enemy object
-            }
-            else if (map_lines.at(h).at(w) == 'D')
-            {
-                int stage = getStage(w);
-                doors[stage] = false;
-            }
+            // found a player character
+            player = Player(h, w, tile); // Ensure Player class has a matching constructor
+        }
+        else if (tile == '0') // Check for end position
+        {
+            // found a food entity
+            food_count[getStage(w)]++; // Count the food of its stage
+        }
+        else if (tile == 'A' || tile == 'B') // Check for food entity
+        {
+            stage_flag_picked[getStage(w)] = false; // Mark the stage as picked
+            stage_flag_placed[getStage(w)] = false; // Mark the stage as placed
+        }
+        else if (tile == 'X')
+        {
+            enemies.add(map, h, w, EnemyBehaviour::Vertical); // Register the enemy
         }
     }
 }
 
 void Game::loadMap(const string &path)
 {
-    // Load the map from the file
-    // Implementation of map loading goes here
-    cout << "Loading map from: " << path << endl;
+    TraceScope span("Game::loadMap");
+    // Stream the map from the file: one line buffer, rows go straight into the grid
+    if (!quiet)
+        cout << "Loading map from: " << path << endl;
+    if (isCompiledMap(path))
+    {
+        loadCompiledMap(path); // Binary maps skip parsing altogether
+        return;
+    }
+    enemies.clear(); // Also drops lazy stepping, initGame turns it back on
+    player = Player();
     ifstream map_file(path);
     string line;
     int h_counter{0}; // For calculating the map height
     int s_counter{0}; // For calculating the number of stages
     int w_counter{0}; // For calculating the map width
-    vector<string> map_lines;
 
     if (!map_file.is_open())
     {
-        cerr << "Error: Could not open map file: " << path << endl;
-        return;
+        throw std::runtime_error("Could not open map file: " + path);
     }
 
+    // The first line holds the stage markers and fixes the width
+    if (!getline(map_file, line) || line == "")
+        throw std::runtime_error("Empty line in map file");
+    w_counter = line.length();
+    h_counter++;
+    vector<int> stage_indices = getStageIndices(line); // Get stage indices from the first line
+    s_counter = stage_indices.size();                  // Count the number of stages
+    index.buildColumns(stage_indices, w_counter);      // Column -> stage table used while reading the rows
+
+    food_count.assign(s_counter, 0);
+    stage_flag_picked.assign(s_counter, false);
+    stage_flag_placed.assign(s_counter, false);
+    doors_opened.assign(s_counter, 0);
+
+    // All lines have the same length, so the file size predicts the height and the grid never reallocates
+    std::streampos rows_start = map_file.tellg();
+    map_file.seekg(0, std::ios::end);
+    std::streamoff rows_size = map_file.tellg() - rows_start;
+    map_file.seekg(rows_start);
+    map.clearRows(w_counter, static_cast<int>(rows_size / (w_counter + 1) + 1));
+
+    if (!quiet)
+        cout << "Creating map..." << endl;
     while (getline(map_file, line))
     {
         // Process each line of the map file
-        // cout << line << endl;
         if (line == "")
             throw std::runtime_error("Empty line in map file");
-        if (h_counter == 0)
-        {
-            w_counter = line.length(); // Set width on first line
-        }
-        else if (line.length() != static_cast<size_t>(w_counter))
+        if (line.length() != static_cast<size_t>(w_counter))
         {
             throw std::runtime_error("Inconsistent line length in map file");
         }
-        h_counter++;               // Increment height counter for each line
-        map_lines.push_back(line); // Store the line in the map
+        createRow(h_counter - 1, line); // Create the map row from the line
+        h_counter++;                    // Increment height counter for each line
+    }
+    if (player.getW() < 0)
+    {
+        throw std::runtime_error("Map has no player: " + path); // Stage lookups of the player column are unchecked
+    }
+    index.buildCells(map); // Door and respawn tables need the filled grid
+
+    if (!quiet)
+    {
+        cout << "Map Size: " << w_counter << "," << h_counter << endl;
+        cout << "Number of stages: " << s_counter << endl;
+    }
+}
+
+void Game::loadCompiledMap(const string &path)
+{
+    MappedMap compiled(path);
+    const CompiledMapHeader &header = compiled.header();
+
+    vector<int> stage_indices(header.stage_count);
+    for (int i{0}; i < header.stage_count; i++)
+    {
+        stage_indices[i] = compiled.stages()[i].start_column;
+    }
+    if (!quiet)
+    {
+        cout << "Map Size: " << header.width << "," << header.height + 1 << endl;
+        cout << "Number of stages: " << header.stage_count << endl;
     }
 
-    this->map.resize(h_counter, std::vector<char>(w_counter)); // Resize the map
+    map.resize(header.height, header.width);
+    for (int h{0}; h < header.height; h++)
+    {
+        map.setRow(h, compiled.tiles() + static_cast<size_t>(h) * header.width); // Straight copy out of the mapping
+    }
+    index.buildColumns(stage_indices, header.width);
+    index.buildCells(map);
+
+    food_count.assign(header.stage_count, 0);
+    stage_flag_picked.assign(header.stage_count, false);
+    stage_flag_placed.assign(header.stage_count, false);
+    doors_opened.assign(header.stage_count, 0);
+    for (int i{0}; i < header.stage_count; i++)
+    {
+        food_count[i] = compiled.stages()[i].food_count;
+    }
+    enemies.clear();
+    for (int i{0}; i < header.enemy_count; i++)
+    {
+        enemies.add(map, compiled.enemies()[i].h, compiled.enemies()[i].w, EnemyBehaviour::Vertical);
+    }
+    player = Player(header.player_h, header.player_w, header.player_direction);
+}
 
-    this->stage_indices = getStageIndices(map_lines.at(0)); // Get stage indices from the first line
-    s_counter = stage_indices.size();                       // Count the number of stages
+void Game::saveCompiledMap(const string &path) const
+{
+    if (cycle != 0)
+    {
+        throw std::runtime_error("Only a freshly loaded map can be compiled"); // Counters must match the tiles
+    }
+    auto align = [](uint64_t offset)
+    { return (offset + 7) & ~uint64_t{7}; };
+
+    CompiledMapHeader header{};
+    std::copy(std::begin(COMPILED_MAP_MAGIC), std::end(COMPILED_MAP_MAGIC), header.magic);
+    header.version = COMPILED_MAP_VERSION;
+    header.width = map.width();
+    header.height = map.height();
+    header.stage_count = index.stageCount();
+    header.enemy_count = enemies.size();
+    player.getPos(header.player_h, header.player_w);
+    header.player_direction = player.getDirection();
+    header.stage_offset = align(sizeof(CompiledMapHeader));
+    header.grid_offset = align(header.stage_offset + sizeof(CompiledStage) * header.stage_count);
+    header.enemy_offset = align(header.grid_offset + static_cast<uint64_t>(header.width) * header.height);
+    header.file_size = header.enemy_offset + sizeof(CompiledEnemy) * header.enemy_count;
+
+    vector<char> image(header.file_size, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    for (int i{0}; i < header.stage_count; i++)
+    {
+        CompiledStage stage{index.stageStart(i), food_count[i]};
+        std::memcpy(image.data() + header.stage_offset + i * sizeof(CompiledStage), &stage, sizeof(stage));
+    }
+    for (int h{0}; h < header.height; h++)
+    {
+        std::copy(map.row(h), map.row(h) + header.width, image.data() + header.grid_offset + static_cast<size_t>(h) * header.width);
+    }
+    for (int i{0}; i < header.enemy_count; i++)
+    {
+        CompiledEnemy enemy{enemies.getH(i), enemies.getW(i)};
+        std::memcpy(image.data() + header.enemy_offset + i * sizeof(CompiledEnemy), &enemy, sizeof(enemy));
+    }
 
-    if (s_counter > 10)
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(image.data(), image.size());
+    if (!out)
     {
-        throw std::runtime_error("Too many stages in map file: " + path + " Modify getStageIndices() \
-             to provide more stages"); // Error if too many stages
+        throw std::runtime_error("Could not write compiled map file: " + path);
     }
+}
 
-    cout << "Map Size: " << w_counter << "," << h_counter << endl;
-    cout << "Number of stages: " << s_counter << endl;
+uint64_t Game::stateHash() const
+{
+    // FNV-1a over everything that can influence the rest of the episode
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i{0}; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    auto mixInt = [&mix](int64_t value)
+    { mix(&value, sizeof(value)); };
 
-    createMap(map_lines); // Create the map from the lines
+    mixInt(map.height());
+    mixInt(map.width());
+    for (int h{0}; h < map.height(); h++)
+    {
+        mix(map.row(h), map.width());
+    }
+    int p_h, p_w;
+    player.getPos(p_h, p_w);
+    mixInt(p_h);
+    mixInt(p_w);
+    mixInt(player.getDirection());
+    mixInt(score);
+    mixInt(cycle);
+    mixInt(max_crossed_stage);
+    mixInt(game_won);
+    for (int i{0}; i < index.stageCount(); i++)
+    {
+        mixInt(index.stageStart(i));
+        mixInt(food_count[i]);
+        mixInt(stage_flag_picked[i]);
+        mixInt(stage_flag_placed[i]);
+        mixInt(doors_opened[i]);
+    }
+    for (size_t i{0}; i < enemies.size(); i++)
+    {
+        mixInt(enemies.getH(i));
+        mixInt(enemies.getW(i));
+        mixInt(enemies.getDirection(i));
+    }
+    return hash;
+}
+
+void Game::saveState(vector<char> &buffer) const
+{
+    // Flat little record: scalars, player, per-stage counters, enemies, then the grid rows
+    buffer.clear();
+    auto put = [&buffer](int32_t value)
+    {
+        const char *bytes = reinterpret_cast<const char *>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    };
+    int p_h, p_w;
+    player.getPos(p_h, p_w);
+    put(map.height());
+    put(map.width());
+    put(index.stageCount());
+    put(enemies.size());
+    put(score);
+    put(cycle);
+    put(max_crossed_stage);
+    put(game_won);
+    put(p_h);
+    put(p_w);
+    put(player.getDirection());
+    for (int i{0}; i < index.stageCount(); i++)
+    {
+        put(food_count[i]);
+        put(stage_flag_picked[i]);
+        put(stage_flag_placed[i]);
+        put(doors_opened[i]);
+    }
+    for (size_t i{0}; i < enemies.size(); i++)
+    {
+        put(enemies.getH(i));
+        put(enemies.getW(i));
+        put(enemies.getDirection(i));
+    }
+    for (int h{0}; h < map.height(); h++)
+    {
+        buffer.insert(buffer.end(), map.row(h), map.row(h) + map.width());
+    }
+}
+
+void Game::loadState(const vector<char> &buffer)
+{
+    discardSnapshots(); // The undo logs cannot describe a jump to an unrelated state
+    size_t offset{0};
+    auto get = [&buffer, &offset]()
+    {
+        int32_t value;
+        if (offset + sizeof(value) > buffer.size())
+            throw std::runtime_error("Truncated game state");
+        std::memcpy(&value, buffer.data() + offset, sizeof(value));
+        offset += sizeof(value);
+        return value;
+    };
+    int height = get();
+    int width = get();
+    int stages = get();
+    int enemy_count = get();
+    if (height != map.height() || width != map.width() || stages != index.stageCount() ||
+        enemy_count != static_cast<int>(enemies.size()))
+    {
+        throw std::runtime_error("Game state does not belong to this map");
+    }
+    score = get();
+    cycle = get();
+    max_crossed_stage = get();
+    game_won = get();
+    int p_h = get();
+    int p_w = get();
+    player = Player(p_h, p_w, static_cast<char>(get()));
+    for (int i{0}; i < stages; i++)
+    {
+        food_count[i] = get();
+        stage_flag_picked[i] = get();
+        stage_flag_placed[i] = get();
+        doors_opened[i] = get();
+    }
+    for (size_t i{0}; i < enemies.size(); i++)
+    {
+        int e_h = get();
+        int e_w = get();
+        enemies.setState(i, e_h, e_w, static_cast<char>(get()));
+    }
+    enemies.resetActivity(); // Every enemy is exact again
+    if (offset + static_cast<size_t>(height) * width != buffer.size())
+        throw std::runtime_error("Truncated game state");
+    for (int h{0}; h < height; h++)
+    {
+        map.setRow(h, buffer.data() + offset + static_cast<size_t>(h) * width);
+    }
 }
 
 void Game::initGame()
 {
-    cout << "======================================================\nStarting CSE232 Maze-Game (Project 3)\n"
-         << "======================================================" << endl;
-    loadMap(path_to_map); // Load the map
+    if (!quiet)
+    {
+        cout << "======================================================\nStarting CSE232 Maze-Game (Project 3)\n"
+             << "======================================================" << endl;
+    }
+    if (pristine)
+    {
+        // Preloaded map: copy the template instead of parsing the file
+        const GameTemplate &start = *pristine;
+        map = start.map;
+        index = start.index;
+        food_count = start.food_count;
+        stage_flag_picked.assign(food_count.size(), false);
+        stage_flag_placed.assign(food_count.size(), false);
+        doors_opened.assign(food_count.size(), 0);
+        enemies = start.enemies;
+        player = start.player;
+        stage_text = start.stage_text;
+    }
+    else
+    {
+        loadMap(path_to_map); // Load the map
+
+        stage_text.assign(map.width(), ' '); // Initialize stage text with spaces
+        const vector<int> &stage_indices = index.stageStarts();
+        for (size_t i{0}; i < stage_indices.size(); i++)
+        {
+            string label = std::to_string(i + 1);
+            size_t end = (i + 1 < stage_indices.size()) ? stage_indices[i + 1] : stage_text.size();
+            size_t length = std::min(label.size(), end - stage_indices[i]); // Clip labels that would run into the next stage
+            stage_text.replace(stage_indices[i], length, label, 0, length);  // Fill the stage text with stage numbers
+        }
+        pristine = std::make_shared<const GameTemplate>(GameTemplate{path_to_map, map, index, food_count, enemies, player, stage_text});
+    }
+    enemies.setLazy(lazy_enemies && !recording, map, index);
+
+    if (visual)
+    {
+        // Delayed modes show every cycle for one frame period (2 per second by default, the old 500 ms sleep).
+        // Their render thread ticks at least twice per cycle, so no cycle is dropped between two draws.
+        bool delayed = visual == 1 || visual == 4;
+        int fps = render_fps > 0 ? render_fps : (delayed ? 2 : 30);
+        cycle_period = delayed ? std::chrono::microseconds(1000000 / fps) : std::chrono::microseconds(0);
+        next_cycle = std::chrono::steady_clock::now();
+        int draw_fps = delayed ? static_cast<int>(std::clamp(2LL * fps, 30LL, 1000LL)) : fps;
+        cout.flush(); // Banners written through cout must land before the first frame
+        render_thread = std::make_unique<RenderThread>(draw_fps, map.height(), map.width());
+    }
+}
+
+void Game::reset()
+{
+    if (!pristine)
+        throw std::runtime_error("Game::reset needs a loaded map (call initGame first)");
+    if (recording)
+        discardSnapshots();
+    // The episode storage already has the template's sizes, so every copy below happens in place
+    const GameTemplate &start = *pristine;
+    map = start.map;
+    std::copy(start.food_count.begin(), start.food_count.end(), food_count.begin());
+    std::fill(stage_flag_picked.begin(), stage_flag_picked.end(), false);
+    std::fill(stage_flag_placed.begin(), stage_flag_placed.end(), false);
+    std::fill(doors_opened.begin(), doors_opened.end(), 0);
+    enemies.restore(start.enemies);
+    player = start.player;
+    score = 0;
+    cycle = 0;
+    max_crossed_stage = 0;
+    game_won = false;
+}
+
+void Game::setProfiler(Profiler *latencies)
+{
+    profiler = latencies;
+}
+
+void Game::setFrameRate(int fps)
+{
+    render_fps = fps;
+}
+
+void Game::stopRendering()
+{
+    if (!render_thread)
+        return;
+    render_thread->stop();
+    string error = render_thread->hasFailed() ? render_thread->error() : "";
+    render_thread.reset();
+    if (!error.empty())
+    {
+        throw std::runtime_error("Rendering stopped early: " + error);
+    }
 }
 
 void Game::advanceGameCycle(int action)
 {
+    TraceScope span("Game::advanceGameCycle");
+    ProfileScope scope(profiler, ProfilePoint::ADVANCE_CYCLE, profiler ? getStage(player.getW()) : 0);
     // Advance game by one cycle implementation
     if (action == 0)
     {
@@ -233,9 +558,10 @@ void Game::advanceGameCycle(int action)
     {
         throw std::runtime_error("Invalid player action: " + std::to_string(action)); // Error if invalid action
     }
-    if (getStage(player.getW()) > max_crossed_stage)
+    int stage = getStage(player.getW());
+    if (stage > max_crossed_stage)
     {
-        max_crossed_stage = getStage(player.getW()); // Update the maximum stage crossed
+        max_crossed_stage = stage; // Update the maximum stage crossed
         score += max_crossed_stage * 10;
     }
     checkEnemies(); // Check the enemies in the game
@@ -256,40 +582,100 @@ int Game::getScore() const
     return score;
 }
 
+int Game::getCycle() const
+{
+    return cycle;
+}
+
+bool Game::isGameWon() const
+{
+    return game_won;
+}
+
 void Game::displayGame()
 {
-    cout << "\033[2J\033[H"; // Clear screen and move cursor to top-left
-    cout << "Stage: " << getStage(player.getW()) << " Score: " << score << " Moves: " << cycle << endl;
-    string stage_text = "";
-    stage_text.resize(map[0].size(), ' '); // Initialize stage text with spaces
-    for (size_t i{0}; i < stage_indices.size(); i++)
+    TraceScope span("Game::displayGame");
+    // Only fill and publish here: drawing happens on the render thread, which drops frames it cannot keep up with
+    if (!render_thread || render_thread->hasFailed())
+        return;
+    enemies.sync(map); // Parked enemies may be in view at the edge of the window
+    fillFrame(render_thread->nextFrame(), !(visual == 3 || visual == 4), render_thread->viewRows(), render_thread->viewCols());
+    render_thread->publish();
+
+    if (cycle_period.count() > 0)
     {
-        stage_text[stage_indices[i]] = std::to_string(i + 1)[0]; // Fill the stage text with stage numbers
+        // Pace the episode, not the drawing: the frame just published stays up until the next cycle is due
+        next_cycle += cycle_period;
+        std::this_thread::sleep_until(next_cycle);
     }
-    cout << stage_text << endl; // Display the stage text
-    for (size_t h{0}; h < map.size(); h++)
+}
+
+void Game::renderFrame(std::ostream &out, bool fog) const
+{
+    out << "Stage: " << getStage(player.getW()) << " Score: " << score << " Moves: " << cycle << endl;
+    out << stage_text << endl; // Display the stage text
+    for (int h{0}; h < map.height(); h++)
     {
-        for (size_t w{0}; w < map.at(h).size(); w++)
+        for (int w{0}; w < map.width(); w++)
         {
-            if (visual == 3 || visual == 4 || isInVision(h, w)) // Check if the position is in vision
+            if (!fog || isInVision(h, w)) // Check if the position is in vision
             {
-                cout << map.at(h).at(w); // Display the map
+                out << map(h, w); // Display the map
             }
             else
             {
-                cout << " ";
+                out << " ";
             }
         }
-        cout << endl;
+        out << endl;
+    }
+}
+
+void Game::fillFrame(Frame &out, bool fog, int max_rows, int max_cols) const
+{
+    int p_h, p_w;
+    player.getPos(p_h, p_w);
+    out.status = "Stage: " + std::to_string(getStage(p_w)) + " Score: " + std::to_string(score) +
+                 " Moves: " + std::to_string(cycle);
+    out.rows = std::min(map.height(), max_rows);
+    out.cols = std::min(map.width(), max_cols);
+    out.top = std::clamp(p_h - out.rows / 2, 0, map.height() - out.rows); // Keep the player centred where possible
+    out.left = std::clamp(p_w - out.cols / 2, 0, map.width() - out.cols);
+    out.cells.resize(static_cast<size_t>(out.rows + 1) * out.cols);
+
+    char *line = out.cells.data();
+    std::copy_n(stage_text.data() + out.left, out.cols, line);
+    for (int r{0}; r < out.rows; r++)
+    {
+        line += out.cols;
+        if (fog)
+            std::fill_n(line, out.cols, ' ');
+        else
+            std::copy_n(map.row(out.top + r) + out.left, out.cols, line);
     }
+    if (!fog)
+        return;
 
-    if (visual == 1 || visual == 4)
+    // Only the vision box shows through the fog: copy it where it overlaps the window
+    Vision vision;
+    getVision(vision);
+    int min_row = p_h - vision.player_row;
+    int min_col = p_w - vision.player_col;
+    for (int i{0}; i < vision.rows; i++)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        int r = min_row + i - out.top;
+        if (r < 0 || r >= out.rows)
+            continue;
+        for (int j{0}; j < vision.cols; j++)
+        {
+            int c = min_col + j - out.left;
+            if (c >= 0 && c < out.cols)
+                out.cells[static_cast<size_t>(r + 1) * out.cols + c] = vision[i][j];
+        }
     }
 }
 
-bool Game::isInVision(int h, int w)
+bool Game::isInVision(int h, int w) const
 {
     int p_w = player.getW();
     int p_h = player.getH();
@@ -337,6 +723,7 @@ bool Game::isInVision(int h, int w)
 
 void Game::movePlayer(int direction)
 {
+    TraceScope span("Game::movePlayer");
     int w, h;
     player.getPos(h, w); // Get the player's position
     int new_w, new_h;    // New position variables
@@ -366,100 +753,194 @@ void Game::movePlayer(int direction)
         throw std::runtime_error("Invalid player movement"); // Error if invalid direction
         break;                                               // Invalid direction, do nothing
     }
-    if (new_h < 0 || new_h >= static_cast<int>(map.size()) || new_w < 0 || new_w >= static_cast<int>(map.at(0).size()))
+    if constexpr (CHECKED_BUILD)
     {
-        throw std::runtime_error("Invalid player movement: out of bounds"); // Error if out of bounds
+        if (!map.inBounds(new_h, new_w))
+        {
+            throw std::runtime_error("Invalid player movement: out of bounds"); // Error if out of bounds
+        }
     }
-    char target_pos = map.at(new_h).at(new_w); // Get the target position
-    map.at(h).at(w) = player.getDirection();
-    if (target_pos == ' ')
+    // Unchecked builds read the '+' border there, so stepping off the map is a bump into a wall
+    const TileKind &tile = TILE_TABLE[static_cast<unsigned char>(map(new_h, new_w))]; // Registry entry of the target
+    map.set(h, w, player.getDirection());
+    MoveOutcome outcome = tile.outcome;
+    if (tile.condition != TileCondition::Always)
     {
-        // Move to empty space
-        map.at(h).at(w) = ' ';                           // Clear the old position
-        map.at(new_h).at(new_w) = player.getDirection(); // Move to the new position
-        player.setPos(new_h, new_w);                     // Update the player's position
+        bool picked = stage_flag_picked[getStage(new_w)];
+        if (picked != (tile.condition == TileCondition::FlagPicked))
+            outcome = MoveOutcome::Block; // e.g. a second 'A', or a 'B' before its 'A'
     }
-    else if (target_pos == '+')
+    switch (outcome)
     {
-        // Do nothing. Hit a wall
+    case MoveOutcome::Block:
+        return; // Hit a wall, a closed door or an unusable flag
+    case MoveOutcome::Die:
+        map.set(h, w, ' ');         // Clear the old position
+        player.respawn(map, index); // Respawn the player
+        return;
+    case MoveOutcome::Step:
+        map.set(h, w, ' ');                           // Clear the old position
+        map.set(new_h, new_w, player.getDirection()); // Move to the new position
+        player.setPos(new_h, new_w);                  // Update the player's position
+        break;
+    case MoveOutcome::Stay:
+        break;
     }
-    else if (target_pos == '0')
+    score += tile.score;
+    if (tile.effect != TileEffect::None)
+        applyTileEffect(tile.effect, getStage(new_w));
+}
+
+void Game::applyTileEffect(TileEffect effect, int stage)
+{
+    switch (effect)
     {
-        map.at(h).at(w) = ' ';                           // Clear the old position
-        map.at(new_h).at(new_w) = player.getDirection(); // Move to the new position
-        player.setPos(new_h, new_w);                     // Update the player's position
-        int stage = getStage(new_w);
+    case TileEffect::None:
+        break;
+    case TileEffect::EatFood:
+        journalCounter(FOOD_COUNT, stage);
         food_count[stage]--; // Decrement the food count for the stage
         if (food_count[stage] == 0)
         {
             openDoor(stage); // Open the door if all food is collected
         }
-        score++; // Increment the score
-    }
-    else if (target_pos == 'A')
-    {
-        // Check if the stage is already picked or placed
-        int stage = getStage(new_w);
-        if (stage_flag_picked[stage] == false)
-        {
-            map.at(h).at(w) = ' ';                           // Clear the old position
-            map.at(new_h).at(new_w) = player.getDirection(); // Move to the new position
-            player.setPos(new_h, new_w);                     // Update the player's position
-            stage_flag_picked[stage] = true;                 // Mark the stage as picked
-            score += 10;                                     // Increment the score
-        }
+        break;
+    case TileEffect::PickFlag:
+        journalCounter(FLAG_PICKED, stage);
+        stage_flag_picked[stage] = true; // Mark the stage as picked
+        break;
+    case TileEffect::PlaceFlag:
+        journalCounter(FLAG_PLACED, stage);
+        stage_flag_placed[stage] = true; // Mark the stage as placed
+        openDoor(stage);                 // Placing the flag opens a door as well
+        break;
+    case TileEffect::ReachGoal:
+        score += MAX_CYCLE - cycle; // Unused cycles are a bonus
+        game_won = true;            // Mark the game as won
+        break;
     }
-    else if (target_pos == 'B' && stage_flag_picked[getStage(new_w)] == true)
+}
+
+void Game::checkEnemies()
+{
+    TraceScope span("Game::checkEnemies");
+    ProfileScope scope(profiler, ProfilePoint::CHECK_ENEMIES, profiler ? getStage(player.getW()) : 0);
+    enemies.update(map, player, index, recording ? &enemy_journal : nullptr); // Only enemies that change are journaled
+}
+
+void Game::journalCounter(Counter counter, int stage)
+{
+    if (!recording)
+        return;
+    int previous{0};
+    switch (counter)
     {
-        map.at(h).at(w) = ' ';                           // Clear the old position
-        map.at(new_h).at(new_w) = player.getDirection(); // Move to the new position
-        player.setPos(new_h, new_w);                     // Update the player's position
-        stage_flag_placed[getStage(new_w)] = true;       // Mark the stage as placed
-        score += 15;                                     // Increment the score
-        openDoor(getStage(new_w));                       // Open the door if all food is placed
+    case FOOD_COUNT:
+        previous = food_count[stage];
+        break;
+    case FLAG_PICKED:
+        previous = stage_flag_picked[stage];
+        break;
+    case FLAG_PLACED:
+        previous = stage_flag_placed[stage];
+        break;
+    case DOORS_OPENED:
+        previous = doors_opened[stage];
+        break;
     }
-    else if (target_pos == 'D')
+    counter_journal.push_back({counter, stage, previous});
+}
+
+GameSnapshot Game::snapshot()
+{
+    if (!recording)
     {
-        // Do nothing. Hit a door
+        enemies.setLazy(false, map, index); // The enemy journal needs every enemy stepped
+        recording = true;
+        map.setRecording(true);
     }
-    else if (target_pos == 'X')
+    GameSnapshot snap;
+    snap.cells = map.journalSize();
+    snap.counters = counter_journal.size();
+    snap.enemies = enemy_journal.size();
+    snap.score = score;
+    snap.cycle = cycle;
+    snap.max_crossed_stage = max_crossed_stage;
+    snap.game_won = game_won;
+    snap.player = player;
+    return snap;
+}
+
+void Game::restore(const GameSnapshot &snap)
+{
+    if (!recording || snap.cells > map.journalSize() || snap.counters > counter_journal.size() ||
+        snap.enemies > enemy_journal.size())
     {
-        // Do nothing. Hit a door
-        map.at(h).at(w) = ' ';              // Clear the old position
-        player.respawn(map, stage_indices); // Respawn the player
+        throw std::runtime_error("Snapshot is no longer valid"); // Taken before a discard or an earlier restore
     }
-    else if (target_pos == 'T')
+    map.rollback(snap.cells);
+    while (counter_journal.size() > snap.counters)
     {
-        map.at(h).at(w) = ' ';              // Clear the old position
-        player.respawn(map, stage_indices); // Respawn the player
+        const CounterUndo &undo = counter_journal.back();
+        switch (undo.counter)
+        {
+        case FOOD_COUNT:
+            food_count[undo.stage] = undo.previous;
+            break;
+        case FLAG_PICKED:
+            stage_flag_picked[undo.stage] = undo.previous;
+            break;
+        case FLAG_PLACED:
+            stage_flag_placed[undo.stage] = undo.previous;
+            break;
+        case DOORS_OPENED:
+            doors_opened[undo.stage] = undo.previous;
+            break;
+        }
+        counter_journal.pop_back();
     }
-    else if (target_pos == 'w')
+    while (enemy_journal.size() > snap.enemies)
     {
-        score += 1000;
-        score += MAX_CYCLE - cycle; // Increment the score
-        game_won = true;            // Mark the game as won
+        enemies.undo(enemy_journal.back());
+        enemy_journal.pop_back();
     }
+    score = snap.score;
+    cycle = snap.cycle;
+    max_crossed_stage = snap.max_crossed_stage;
+    game_won = snap.game_won;
+    player = snap.player;
 }
 
-void Game::checkEnemies()
+void Game::discardSnapshots()
 {
-    for (auto &enemy : enemies)
-    {
-        enemy.move(map, player, stage_indices); // Move the enemy
-    }
+    recording = false;
+    map.setRecording(false);
+    counter_journal.clear();
+    enemy_journal.clear();
+    enemies.setLazy(lazy_enemies, map, index);
+}
+
+void Game::setLazyEnemies(bool on)
+{
+    lazy_enemies = on;
+    if (!recording)
+        enemies.setLazy(on, map, index); // Otherwise discardSnapshots turns it on
+}
+
+void Game::syncEnemies()
+{
+    enemies.sync(map);
 }
 
 void Game::openDoor(int stage)
 {
-    int w = stage_indices[stage + 1];
-    for (int i{0}; i < static_cast<int>(map.size()); i++)
+    // Doors open top to bottom; 'D' cells are never created, so a cursor replaces the column scan
+    const int *door = index.doorsBegin(stage) + doors_opened[stage];
+    if (door < index.doorsEnd(stage))
     {
-        if (map[i][w] == 'D')
-        {
-            map[i][w] = ' ';     // Open the door
-            doors[stage] = true; // Mark the door as open
-            break;
-        }
+        map.set(*door, index.stageStart(stage + 1), ' '); // Open the door
+        journalCounter(DOORS_OPENED, stage);
+        doors_opened[stage]++;                           // Mark the door as open
     }
 }
 
@@ -467,20 +948,29 @@ GameState Game::getGameState()
 {
     // Return current game state
     GameState game_state;
+    getGameState(game_state);
+    return game_state;
+}
 
+void Game::getGameState(GameState &game_state)
+{
     int h, w;
-    player.getPos(h, w);             // Get the player's position
-    int stage = getStage(w);         // Get the stage number
-    game_state.stage = stage;        // Set the stage number
-    game_state.score = score;        // Set the score
-    game_state.cycle = cycle;        // Set the cycle
-    game_state.vision = getVision(); // Get the player's vision
-    game_state.pos[0] = h;           // Set the player's height
-    game_state.pos[1] = w;           // Set the player's width
+    player.getPos(h, w);     // Get the player's position
+    int stage = getStage(w); // Get the stage number
+    TraceScope span("Game::getGameState", stage);
+    {
+        ProfileScope scope(profiler, ProfilePoint::GET_VISION, stage);
+        game_state.stage = stage;     // Set the stage number
+        game_state.score = score;     // Set the score
+        game_state.cycle = cycle;     // Set the cycle
+        getVision(game_state.vision); // Get the player's vision
+        game_state.pos[0] = h;        // Set the player's height
+        game_state.pos[1] = w;        // Set the player's width
+    }
 
     if (visual) // any value greater than 0 is true
     {
+        ProfileScope scope(profiler, ProfilePoint::DISPLAY, stage);
         displayGame();
     }
-    return game_state;
 }
\ No newline at end of file
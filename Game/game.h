@@ -3,59 +3,169 @@
 
 #include <string>
 #include <cctype>
-#include <unordered_map>
 #include <vector>
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <span>
 
+#include "grid.h"
+#include "map_index.h"
 #include "player.h"
 #include "enemy.h"
+#include "renderer.h"
+#include "render_thread.h"
+#include "profiler.h"
+
+// Copy of the player's vision box held in a fixed inline buffer (the box is at
+// most 7 x 5 cells), so filling it never touches the heap. Rows are read like the
+// old vector<vector<char>>: vision.size(), vision[i].size(), vision[i][j].
+struct Vision
+{
+    static constexpr int MAX_DIM = 7;           // Longest side of the vision box
+    std::array<char, MAX_DIM * MAX_DIM> cells{}; // Row-major, row stride MAX_DIM
+    int rows{0};                                 // Rows in the window (after clipping to the map)
+    int cols{0};                                 // Columns in the window (after clipping to the map)
+    int player_row{-1};                          // Player offset inside the window (-1 if empty)
+    int player_col{-1};
+    char facing{' '};                            // Direction the player is facing
+
+    size_t size() const { return rows; }
+    bool empty() const { return rows == 0; }
+    std::span<const char> operator[](size_t row) const { return {&cells[row * MAX_DIM], static_cast<size_t>(cols)}; }
+};
 
 struct GameState
 {
-    int stage{0};                          // Current stage
-    int score{0};                          // Current score
-    int cycle{0};                          // Current cycle
-    std::vector<std::vector<char>> vision; // Vision of the player
-    std::array<int, 2> pos;                // Player position (h, w)
+    int stage{0};           // Current stage
+    int score{0};           // Current score
+    int cycle{0};           // Current cycle
+    Vision vision;          // Vision of the player
+    std::array<int, 2> pos; // Player position (h, w)
+};
+
+// Point in time a Game can be rolled back to with Game::restore. Only the
+// scalars are copied; the grid, counters and enemies are rolled back from undo
+// logs, so a restore costs time proportional to what changed since.
+struct GameSnapshot
+{
+    size_t cells{0};    // Grid journal mark
+    size_t counters{0}; // Counter journal mark
+    size_t enemies{0};  // Enemy journal mark
+    int score{0};
+    int cycle{0};
+    int max_crossed_stage{0};
+    bool game_won{false};
+    Player player;
+};
+
+// Everything a map defines, captured once right after it was loaded. It is
+// never modified afterwards, so any number of Games (on any thread) can share
+// one and start or reset episodes by copying from it instead of parsing the map.
+struct GameTemplate
+{
+    std::string path;            // Map file it was loaded from
+    Grid map;
+    MapIndex index;
+    std::vector<int> food_count; // Food per stage at the start
+    Enemies enemies;             // Start positions and directions
+    Player player;
+    std::string stage_text;      // Stage marker row as displayed
 };
 
 class Game
 {
+    friend struct GameBench;     // Tools/bench.cpp times the private steps of a cycle
+    friend struct LockstepProbe; // Tools/lockstep.cpp compares the grid and player against the reference engine
+
     std::string path_to_map;
     const int MAX_CYCLE{1000};
     int score{0};
     int cycle{0};
     int visual{0}; // Flag for visual mode
-    std::vector<std::vector<char>> map;
-    std::vector<int> stage_indices;                  // Indices of stages in the map
-    std::unordered_map<int, int> food_count;         // Count of food items per stage (key: stage, value: count)
-    std::unordered_map<int, bool> stage_flag_picked; // Flags for stages (picked)
-    std::unordered_map<int, bool> stage_flag_placed; // Flags for stages (placed)
-    std::unordered_map<int, bool> doors;             // Door states for stages
-    std::vector<Enemy> enemies;                      // Vector of enemies
+    bool quiet{false}; // Suppresses console banners (headless runs)
+    Grid map;                                        // Flat, padded tile grid with flag plane
+    MapIndex index;                                  // Stage, door and spawn lookup tables built at load time
+    std::vector<int> food_count;                     // Count of food items per stage
+    std::vector<uint8_t> stage_flag_picked;          // Flags for stages (picked)
+    std::vector<uint8_t> stage_flag_placed;          // Flags for stages (placed)
+    std::vector<int> doors_opened;                   // Doors opened so far per stage
+    Enemies enemies;                                 // Every enemy, stored as parallel arrays
     Player player;
-    int max_crossed_stage{0}; // Maximum stage crossed by the player
-    bool game_won{false};     // Flag for game won state
+    int max_crossed_stage{0};  // Maximum stage crossed by the player
+    bool game_won{false};      // Flag for game won state
+    std::string stage_text;    // Stage marker row as displayed (built at load time)
+    int render_fps{0};         // Frames per second in the visual modes (0 = mode default)
+    std::unique_ptr<RenderThread> render_thread; // Draws published frames in the visual modes
+    std::chrono::microseconds cycle_period{0};   // Time each cycle stays on screen in the delayed modes (0 = unpaced)
+    std::chrono::steady_clock::time_point next_cycle; // When the delayed modes may show the next cycle
+    Profiler *profiler{nullptr};                 // Latency histograms of the hot calls (null = profiling off)
+    bool lazy_enemies{false};                    // Enemies away from the player are caught up on demand
+    std::shared_ptr<const GameTemplate> pristine; // Start of an episode on this map (set by initGame)
+
+    // Undo logs, filled only while a snapshot is outstanding
+    enum Counter : uint8_t
+    {
+        FOOD_COUNT,
+        FLAG_PICKED,
+        FLAG_PLACED,
+        DOORS_OPENED
+    };
+    struct CounterUndo
+    {
+        Counter counter;
+        int stage;
+        int previous;
+    };
+    bool recording{false};
+    std::vector<CounterUndo> counter_journal;
+    std::vector<Enemies::Undo> enemy_journal;
 
 private:
     void loadMap(const std::string &);                     // Loads the map from a file
-    void createMap(const std::vector<std::string> &);      // Creates a map of given lines
+    void loadCompiledMap(const std::string &);             // Loads a compiled (.mapb) map through mmap
+    void createRow(int, const std::string &);              // Appends one map line to the grid and registers its entities
     std::vector<int> getStageIndices(const std::string &); // Gets stage indices from a line
-    int getStage(int);                                     // Gets the stage number based on col value (w value)
-    std::vector<std::vector<char>> getVision();            // Gets the vision of the player based on position and direction
+    int getStage(int w) const { return index.stageOf(w); } // Gets the stage number based on col value (w value)
+    void getVision(Vision &) const;                        // Fills the vision of the player based on position and direction
     void displayGame();
-    bool isInVision(int, int);
+    void fillFrame(Frame &, bool fog, int max_rows, int max_cols) const; // Window of the map around the player
+    bool isInVision(int, int) const;
     void movePlayer(int direction);
+    void applyTileEffect(TileEffect effect, int stage); // Stage bookkeeping after entering a tile
     void checkEnemies();      // Checks the enemies in the game
     void openDoor(int stage); // Opens the door for the given stage
+    void journalCounter(Counter, int stage); // Saves a per-stage counter before it changes
 
 public:
-    Game(const std::string &, int); // Constructor
-    void initGame();                // Initializes and starts the game
+    Game(const std::string &, int, bool quiet = false); // Constructor
+    explicit Game(std::shared_ptr<const GameTemplate>, int visual = 0, bool quiet = true); // Game on a preloaded map
+    static std::shared_ptr<const GameTemplate> loadTemplate(const std::string &); // Parses a map once for many games
+    void initGame();                // Initializes and starts the game (copies the template instead of parsing, if given)
+    void reset();                   // Starts a new episode from the template: bulk copies into the existing storage
+    std::shared_ptr<const GameTemplate> getTemplate() const { return pristine; }
     void advanceGameCycle(int);     // Advances the game state by one cycle
     bool isGameOver() const;        // Checks if the game is over
     int getScore() const;           // Gets current score
+    int getCycle() const;           // Gets current cycle
+    bool isGameWon() const;         // Checks if the player reached the goal
     GameState getGameState();       // Gets the current game state
+    void getGameState(GameState &); // Fills the current game state in place (no allocation)
+    void setFrameRate(int fps);     // Frame rate of the visual modes, call before initGame
+    void stopRendering();           // Draws the last frame and stops the render thread, throws if drawing failed
+    void setProfiler(Profiler *);   // Records call latencies into the profiler (null turns it off)
+    void setLazyEnemies(bool);      // Steps only the enemies near the player (off while a snapshot is outstanding)
+    void syncEnemies();             // Catches up parked enemies; call before the const observers below in lazy mode
+    void saveCompiledMap(const std::string &) const; // Writes the freshly loaded map in the compiled format
+    uint64_t stateHash() const;                      // Hash of the complete game state (grid, entities, counters)
+    void saveState(std::vector<char> &) const;       // Serializes the complete game state (replaces the buffer contents)
+    void loadState(const std::vector<char> &);       // Restores a state written by saveState on the same map
+    void renderFrame(std::ostream &, bool fog) const; // Writes the status line, stage markers and map
+    GameSnapshot snapshot();               // Marks the current state and starts journaling changes
+    void restore(const GameSnapshot &);    // Rolls back to a snapshot (later snapshots become invalid)
+    void discardSnapshots();               // Stops journaling and frees the undo logs
 };
 
 #endif // GAME_H
\ No newline at end of file
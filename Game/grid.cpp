@@ -0,0 +1,93 @@
+#include "grid.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+void throwOutOfBounds(const std::string &what)
+{
+    throw std::out_of_range(what + " is out of range");
+}
+
+Grid::Grid(int height, int width)
+{
+    resize(height, width);
+}
+
+void Grid::resize(int height, int width)
+{
+    if (height < 0 || width < 0)
+    {
+        throw std::runtime_error("Invalid grid size: " + std::to_string(height) + "x" + std::to_string(width));
+    }
+    rows = height;
+    cols = width;
+    stride = width + 2;
+    size_t padded = static_cast<size_t>(height + 2) * stride;
+    cells.assign(padded, '+');                          // Border (and interior, overwritten below)
+    flags_.assign(padded, TILE_FLAGS[static_cast<unsigned char>('+')]);
+    for (int h{0}; h < rows; h++)
+    {
+        for (int w{0}; w < cols; w++)
+        {
+            set(h, w, ' ');
+        }
+    }
+}
+
+char Grid::at(int h, int w) const
+{
+    if (!inBounds(h, w))
+    {
+        throw std::out_of_range("Grid position out of range: " + std::to_string(h) + "," + std::to_string(w));
+    }
+    return (*this)(h, w);
+}
+
+void Grid::setRow(int h, const char *tiles)
+{
+    size_t first = index(h, 0);
+    std::copy(tiles, tiles + cols, cells.begin() + first);
+    for (int w{0}; w < cols; w++)
+    {
+        flags_[first + w] = TILE_FLAGS[static_cast<unsigned char>(tiles[w])];
+    }
+}
+
+void Grid::clearRows(int width, int expected_height)
+{
+    resize(0, width);
+    cells.reserve(static_cast<size_t>(expected_height + 2) * stride);
+    flags_.reserve(static_cast<size_t>(expected_height + 2) * stride);
+}
+
+void Grid::appendRow(const char *tiles)
+{
+    // The bottom border row becomes the new row, then a fresh border row follows it
+    rows++;
+    cells.resize(static_cast<size_t>(rows + 2) * stride, '+');
+    flags_.resize(static_cast<size_t>(rows + 2) * stride, TILE_FLAGS[static_cast<unsigned char>('+')]);
+    setRow(rows - 1, tiles);
+}
+
+void Grid::setRecording(bool on)
+{
+    recording = on;
+    if (!on)
+        journal.clear();
+}
+
+void Grid::record(size_t i)
+{
+    journal.emplace_back(i, cells[i]);
+}
+
+void Grid::rollback(size_t mark)
+{
+    while (journal.size() > mark)
+    {
+        auto [i, tile] = journal.back();
+        journal.pop_back();
+        cells[i] = tile;
+        flags_[i] = TILE_FLAGS[static_cast<unsigned char>(tile)];
+    }
+}
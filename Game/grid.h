@@ -0,0 +1,87 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bounds.h"
+#include "tiles.h"
+
+// Row-major map storage with a one cell '+' border around the playable area.
+// Cell (h, w) lives at index (h + 1) * stride + (w + 1), so every neighbour of a
+// valid cell is addressable without a bounds check. A flag plane parallel to the
+// cells keeps the TileFlag bits of each cell up to date on every write.
+class Grid
+{
+    int rows{0};    // Playable height
+    int cols{0};    // Playable width
+    int stride{2};  // Bytes per padded row (cols + 2)
+    std::vector<char> cells;     // Tile characters, padded
+    std::vector<uint8_t> flags_; // TileFlag bits, padded
+    std::vector<std::pair<uint32_t, char>> journal; // (cell, previous tile) of every write while recording
+    bool recording{false};
+
+    void record(size_t i); // Journals the current tile of cell i
+
+    void check(int h, int w) const // Playable cell, checked builds only
+    {
+        if constexpr (CHECKED_BUILD)
+        {
+            if (!inBounds(h, w))
+                throwOutOfBounds("Grid position " + std::to_string(h) + "," + std::to_string(w));
+        }
+    }
+    void checkIndex(size_t i) const // Padded index (border included), checked builds only
+    {
+        if constexpr (CHECKED_BUILD)
+        {
+            if (i >= cells.size())
+                throwOutOfBounds("Grid index " + std::to_string(i));
+        }
+    }
+
+public:
+    Grid() = default;
+    Grid(int height, int width); // Creates a height x width grid of ' ' with a '+' border
+
+    void resize(int height, int width); // Discards the contents, same layout as the constructor
+    void clearRows(int width, int expected_height = 0); // Zero rows of the given width, room for expected_height
+    void appendRow(const char *tiles);                  // Adds a row of width() tiles below the last one
+    int height() const { return rows; }
+    int width() const { return cols; }
+    bool empty() const { return rows == 0 || cols == 0; }
+    bool inBounds(int h, int w) const { return h >= 0 && h < rows && w >= 0 && w < cols; }
+
+    size_t index(int h, int w) const { return static_cast<size_t>(h + 1) * stride + (w + 1); }
+    char operator()(int h, int w) const { check(h, w); return cells[index(h, w)]; } // Read (checked per build policy)
+    uint8_t flags(int h, int w) const { check(h, w); return flags_[index(h, w)]; }  // Flag read (checked per build policy)
+    char at(int h, int w) const;                                        // Always checked read, throws std::out_of_range
+    void set(int h, int w, char tile) { check(h, w); setCell(index(h, w), tile); } // Write, keeps flags in sync
+    void setRow(int h, const char *tiles);                        // Copies width() tiles into row h
+    const char *row(int h) const { return &cells[index(h, 0)]; } // First playable cell of row h
+
+    // Raw access by padded index, for hot loops that step through the grid by offsets
+    int rowStride() const { return stride; }                               // Index offset between vertical neighbours
+    int rowOf(size_t i) const { return static_cast<int>(i / stride) - 1; } // Playable row of a padded index
+    int colOf(size_t i) const { return static_cast<int>(i % stride) - 1; } // Playable column of a padded index
+    char cell(size_t i) const { checkIndex(i); return cells[i]; }         // Read by padded index
+    uint8_t flagsAt(size_t i) const { checkIndex(i); return flags_[i]; }  // Flag read by padded index
+    void setCell(size_t i, char tile)                                      // Write by padded index
+    {
+        checkIndex(i);
+        if (recording)
+            record(i); // Out of line, so the common path stays small enough to inline everywhere
+        cells[i] = tile;
+        flags_[i] = TILE_FLAGS[static_cast<unsigned char>(tile)];
+    }
+
+    void setRecording(bool on);                               // Journals writes from now on (off also drops the journal)
+    size_t journalSize() const { return journal.size(); }     // Mark to roll back to
+    void rollback(size_t mark);                               // Undoes the writes made after mark, newest first
+};
+
+#endif // GRID_H
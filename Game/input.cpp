@@ -0,0 +1,166 @@
+#include "input.h"
+
+#include <cerrno>
+#include <csignal>
+#include <stdexcept>
+
+#include <poll.h>
+#include <unistd.h>
+
+namespace
+{
+    termios terminal_at_start;               // Copy for the signal handler
+    volatile std::sig_atomic_t restore_on_signal = 0;
+
+    void restoreAndReraise(int signal)
+    {
+        if (restore_on_signal)
+            tcsetattr(STDIN_FILENO, TCSANOW, &terminal_at_start); // Async-signal-safe
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+
+    int actionOfKey(char key)
+    {
+        switch (key)
+        {
+        case 'n':
+            return 0; // do nothing
+        case 'w':
+            return 1; // Move up
+        case 'a':
+            return 2; // Move left
+        case 's':
+            return 3; // Move down
+        case 'd':
+            return 4; // Move right
+        case 'x':
+            return KeyboardInput::QUIT;
+        default:
+            return -2; // Not a game key
+        }
+    }
+
+    int actionOfArrow(char final_byte) // ESC [ A..D
+    {
+        switch (final_byte)
+        {
+        case 'A':
+            return 1;
+        case 'D':
+            return 2;
+        case 'B':
+            return 3;
+        case 'C':
+            return 4;
+        default:
+            return -2;
+        }
+    }
+}
+
+KeyboardInput::KeyboardInput()
+{
+    if (::pipe(wake) != 0)
+        throw std::runtime_error("Could not create the keyboard wake-up pipe");
+    if (tcgetattr(STDIN_FILENO, &saved) != 0)
+    {
+        // Not a terminal (piped input): read it as it is, there is no mode to set or restore
+    }
+    else
+    {
+        termios settings = saved;
+        settings.c_lflag &= ~(ICANON | ECHO); // Keys arrive one by one and are not echoed; Ctrl-C still works
+        settings.c_cc[VMIN] = 1;
+        settings.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &settings) == 0)
+        {
+            raw = true;
+            terminal_at_start = saved;
+            restore_on_signal = 1;
+            std::signal(SIGINT, restoreAndReraise);
+            std::signal(SIGTERM, restoreAndReraise);
+        }
+    }
+    reader = std::thread(&KeyboardInput::run, this);
+}
+
+KeyboardInput::~KeyboardInput()
+{
+    char stop = 0;
+    (void)!::write(wake[1], &stop, 1);
+    reader.join();
+    ::close(wake[0]);
+    ::close(wake[1]);
+    if (raw)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        restore_on_signal = 0;
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+    }
+}
+
+void KeyboardInput::run()
+{
+    pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {wake[0], POLLIN, 0}};
+    char buffer[64];
+    int escape{0}; // Bytes of an arrow key sequence seen so far
+    while (true)
+    {
+        if (::poll(fds, 2, -1) < 0)
+            continue; // Interrupted by a signal
+        if (fds[1].revents)
+            return;
+        if (!fds[0].revents)
+            continue;
+        ssize_t count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (count <= 0)
+        {
+            if (count < 0 && errno == EINTR)
+                continue;
+            actions.push(QUIT); // End of input: nobody can steer any more
+            return;
+        }
+        for (ssize_t i{0}; i < count; i++)
+        {
+            char key = buffer[i];
+            int action;
+            if (escape == 2)
+            {
+                escape = 0;
+                action = actionOfArrow(key);
+            }
+            else if (escape == 1)
+            {
+                escape = key == '[' ? 2 : 0;
+                continue;
+            }
+            else if (key == 27)
+            {
+                escape = 1;
+                continue;
+            }
+            else
+            {
+                action = actionOfKey(key);
+            }
+            if (action != -2)
+                actions.push(static_cast<int8_t>(action)); // A full queue drops the key, like a key-repeat overflow
+        }
+    }
+}
+
+int KeyboardInput::waitAction()
+{
+    int8_t action;
+    while (!actions.pop(action))
+        actions.wait();
+    return action;
+}
+
+int KeyboardInput::nextAction()
+{
+    int8_t action;
+    return actions.pop(action) ? action : 0;
+}
@@ -0,0 +1,79 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include <termios.h>
+
+// Bounded ring handing values from one producer thread to one consumer thread.
+// Each side owns one index and only reads the other's, so neither push nor pop
+// takes a lock; a full queue drops the new value instead of waiting.
+template <typename T, size_t N>
+class SpscQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+    alignas(64) std::atomic<uint32_t> head{0}; // Next slot to pop, written by the consumer
+    alignas(64) std::atomic<uint32_t> tail{0}; // Next slot to push, written by the producer
+    std::array<T, N> items;
+
+public:
+    bool push(const T &value) // Producer side, false when full
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+            return false;
+        items[t & (N - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        tail.notify_one(); // Only wakes a consumer blocked in wait()
+        return true;
+    }
+    bool pop(T &value) // Consumer side, false when empty
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = items[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    void wait() const // Consumer side, blocks until something can be popped
+    {
+        tail.wait(head.load(std::memory_order_relaxed), std::memory_order_acquire);
+    }
+};
+
+// Keyboard of a human player. The terminal is switched to raw mode once for the
+// whole session, and a reader thread polls stdin and queues the keys as actions,
+// so reading a move never blocks the game loop or touches the terminal settings.
+// POSIX only (termios and poll), like the memory-mapped maps and the shared-memory
+// server; the old _getch path for Windows consoles is gone.
+class KeyboardInput
+{
+public:
+    static constexpr int QUIT = -1; // Action of 'x' and of the end of input
+
+private:
+    SpscQueue<int8_t, 64> actions; // Keys pressed but not played yet
+    termios saved{};               // Terminal settings to restore
+    bool raw{false};               // Raw mode was set (stdin is a terminal)
+    int wake[2]{-1, -1};           // Pipe that interrupts the reader's poll on shutdown
+    std::thread reader;
+
+private:
+    void run(); // Reader loop
+
+public:
+    KeyboardInput();  // Enters raw mode and starts reading
+    ~KeyboardInput(); // Stops the reader and restores the terminal
+    KeyboardInput(const KeyboardInput &) = delete;
+    KeyboardInput &operator=(const KeyboardInput &) = delete;
+
+    int waitAction(); // Next queued action, blocks until a key arrives (turn-based play)
+    int nextAction(); // Next queued action, 0 (stay) when none is pending (real-time play)
+};
+
+#endif // INPUT_H
@@ -0,0 +1,110 @@
+#include "map_file.h"
+#include "tiles.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::string;
+
+MappedMap::MappedMap(const string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not open compiled map file: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(CompiledMapHeader)))
+    {
+        ::close(fd);
+        throw std::runtime_error("Compiled map file is truncated: " + path);
+    }
+    length = info.st_size;
+    data = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+    if (data == MAP_FAILED)
+    {
+        data = nullptr;
+        throw std::runtime_error("Could not map compiled map file: " + path);
+    }
+
+    const char *problem = validate();
+    if (problem)
+    {
+        ::munmap(data, length);
+        data = nullptr;
+        throw std::runtime_error("Invalid compiled map file (" + string(problem) + "): " + path);
+    }
+}
+
+const char *MappedMap::validate() const
+{
+    const CompiledMapHeader &h = header();
+    if (std::memcmp(h.magic, COMPILED_MAP_MAGIC, sizeof(h.magic)) != 0 || h.version != COMPILED_MAP_VERSION)
+        return "bad magic or version";
+    if (h.file_size != length || h.width < 0 || h.height < 0 || h.stage_count < 0 || h.enemy_count < 0)
+        return "bad sizes";
+    if (h.stage_offset > length || h.grid_offset > length || h.enemy_offset > length ||
+        h.stage_offset + sizeof(CompiledStage) * static_cast<uint64_t>(h.stage_count) > length ||
+        h.grid_offset + static_cast<uint64_t>(h.width) * h.height > length ||
+        h.enemy_offset + sizeof(CompiledEnemy) * static_cast<uint64_t>(h.enemy_count) > length)
+        return "section outside the file";
+
+    // Every tile byte goes through the tile tables: registered tiles and the player glyphs only
+    const char *tile = tiles();
+    for (uint64_t i{0}; i < static_cast<uint64_t>(h.width) * h.height; i++)
+    {
+        unsigned char c = tile[i];
+        if (TILE_FLAGS[c] == 0 && c != 'v' && c != '^' && c != '<' && c != '>')
+            return "unknown tile";
+    }
+
+    // Game copies these straight into the grid and its tables, unchecked builds index with them as they are
+    for (int i{0}; i < h.stage_count; i++)
+    {
+        const CompiledStage &stage = stages()[i];
+        if (stage.start_column < 0 || stage.start_column >= h.width)
+            return "stage start outside the map";
+        if (i > 0 && stage.start_column <= stages()[i - 1].start_column)
+            return "stage starts not increasing";
+        if (stage.food_count < 0)
+            return "negative food count";
+    }
+    for (int i{0}; i < h.enemy_count; i++)
+    {
+        const CompiledEnemy &enemy = enemies()[i];
+        if (enemy.h < 0 || enemy.h >= h.height || enemy.w < 0 || enemy.w >= h.width)
+            return "enemy outside the map";
+        if (tile[static_cast<size_t>(enemy.h) * h.width + enemy.w] != 'X')
+            return "enemy not on an 'X' tile";
+    }
+    if (h.player_h == -1 && h.player_w == -1)
+        return "no player"; // Stage lookups of the player column are unchecked
+    if (h.player_h < 0 || h.player_h >= h.height || h.player_w < 0 || h.player_w >= h.width)
+        return "player outside the map";
+    if (h.player_direction != 'v' && h.player_direction != '^' && h.player_direction != '<' && h.player_direction != '>')
+        return "bad player direction";
+    if (tile[static_cast<size_t>(h.player_h) * h.width + h.player_w] != h.player_direction)
+        return "player not on its tile";
+    return nullptr;
+}
+
+MappedMap::~MappedMap()
+{
+    if (data)
+        ::munmap(data, length);
+}
+
+bool isCompiledMap(const string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(COMPILED_MAP_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, COMPILED_MAP_MAGIC, sizeof(magic)) == 0;
+}
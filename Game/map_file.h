@@ -0,0 +1,78 @@
+#ifndef MAP_FILE_H
+#define MAP_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Compiled map format (.mapb), all integers in host byte order:
+//   CompiledMapHeader
+//   CompiledStage[stage_count]    stage table
+//   char[height * width]          tile grid, row-major, no marker line
+//   CompiledEnemy[enemy_count]    entity list
+// Sections start at the offsets stored in the header (8-byte aligned).
+//
+// The file saves the text parsing, not the grid memory: the game changes its
+// grid every cycle (player, enemies, doors), so each Game copies the tiles out
+// of the shared mapping into its own padded Grid, width * height bytes per
+// process. Only the mapped file pages are shared between processes.
+constexpr char COMPILED_MAP_MAGIC[4] = {'M', 'Z', 'M', 'B'};
+constexpr uint32_t COMPILED_MAP_VERSION = 1;
+
+struct CompiledMapHeader
+{
+    char magic[4];         // COMPILED_MAP_MAGIC
+    uint32_t version;      // COMPILED_MAP_VERSION
+    int32_t width;         // Map width (columns)
+    int32_t height;        // Map height (rows, without the marker line)
+    int32_t stage_count;   // Entries in the stage table
+    int32_t enemy_count;   // Entries in the enemy list
+    int32_t player_h;      // Player start cell (every map has one)
+    int32_t player_w;
+    char player_direction; // Player glyph ('v', '^', '<', '>')
+    char reserved[3];
+    uint32_t stage_offset; // Byte offset of the stage table
+    uint64_t grid_offset;  // Byte offset of the tile grid
+    uint64_t enemy_offset; // Byte offset of the enemy list
+    uint64_t file_size;    // Total size, checked against the mapped file
+};
+
+struct CompiledStage
+{
+    int32_t start_column; // First column of the stage
+    int32_t food_count;   // '0' tiles in the stage
+};
+
+struct CompiledEnemy
+{
+    int32_t h; // Row of the 'X'
+    int32_t w; // Column of the 'X'
+};
+
+// Read-only memory mapping of a compiled map. The pages are shared by every
+// process that maps the same file; Game copies the grid out of it on load.
+// The constructor validates every field and tile byte before anything is read.
+class MappedMap
+{
+    void *data{nullptr};
+    size_t length{0};
+
+public:
+    explicit MappedMap(const std::string &path); // Maps and validates the file, throws std::runtime_error
+    ~MappedMap();
+    MappedMap(const MappedMap &) = delete;
+    MappedMap &operator=(const MappedMap &) = delete;
+
+    const CompiledMapHeader &header() const { return *static_cast<const CompiledMapHeader *>(data); }
+    const CompiledStage *stages() const { return reinterpret_cast<const CompiledStage *>(bytes() + header().stage_offset); }
+    const char *tiles() const { return bytes() + header().grid_offset; }
+    const CompiledEnemy *enemies() const { return reinterpret_cast<const CompiledEnemy *>(bytes() + header().enemy_offset); }
+
+private:
+    const char *bytes() const { return static_cast<const char *>(data); }
+    const char *validate() const; // What is wrong with the mapped file, nullptr if it is safe to load
+};
+
+bool isCompiledMap(const std::string &path); // True if the file starts with COMPILED_MAP_MAGIC
+
+#endif // MAP_FILE_H
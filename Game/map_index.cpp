@@ -0,0 +1,60 @@
+#include "map_index.h"
+
+using std::vector;
+
+void MapIndex::buildColumns(const vector<int> &stage_starts, int width)
+{
+    stage_indices = stage_starts;
+    column_stage.assign(width, -1);
+    for (size_t i{0}; i < stage_indices.size(); i++)
+    {
+        int end = (i + 1 < stage_indices.size()) ? stage_indices[i + 1] : width;
+        for (int w = stage_indices[i]; w < end && w < width; w++)
+        {
+            column_stage[w] = i; // Columns from this marker up to the next one belong to stage i
+        }
+    }
+}
+
+void MapIndex::buildCells(const Grid &map)
+{
+    // Unchecked builds look stages up without a range check, so no entity may stand outside one
+    for (int w{0}; w < map.width(); w++)
+    {
+        if (column_stage[w] >= 0)
+            continue;
+        for (int h{0}; h < map.height(); h++)
+        {
+            if (map(h, w) != '+')
+                throw std::runtime_error("Map has open cells left of the first stage marker (column " + std::to_string(w) + ")");
+        }
+    }
+
+    door_rows.clear();
+    door_begin.clear();
+    spawn_rows.clear();
+    spawn_begin.clear();
+    for (size_t stage{0}; stage < stage_indices.size(); stage++)
+    {
+        door_begin.push_back(door_rows.size());
+        if (stage + 1 < stage_indices.size())
+        {
+            int w = stage_indices[stage + 1]; // Doors of a stage block the start column of the next one
+            for (int h{0}; h < map.height(); h++)
+            {
+                if (map(h, w) == 'D')
+                    door_rows.push_back(h);
+            }
+        }
+
+        spawn_begin.push_back(spawn_rows.size());
+        int w = stage_indices[stage];
+        for (int h{0}; h < map.height(); h++)
+        {
+            if (map(h, w) != '+')
+                spawn_rows.push_back(h); // Anything but a wall may become empty later on
+        }
+    }
+    door_begin.push_back(door_rows.size());
+    spawn_begin.push_back(spawn_rows.size());
+}
@@ -0,0 +1,51 @@
+#ifndef MAP_INDEX_H
+#define MAP_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "grid.h"
+
+// Lookup tables built once while the map is created, so the per-cycle
+// bookkeeping (stage of a column, door to open, respawn cell) is a plain array
+// access instead of a scan.
+class MapIndex
+{
+    std::vector<int> stage_indices; // First column of every stage (from the marker line)
+    std::vector<int> column_stage;  // Stage of every column (-1 left of the first marker)
+    std::vector<int> door_rows;     // Rows of the 'D' cells each stage opens, top to bottom, all stages back to back
+    std::vector<int> door_begin;    // door_rows range of stage s: [door_begin[s], door_begin[s + 1])
+    std::vector<int> spawn_rows;    // Non-wall rows of each stage's start column, all stages back to back
+    std::vector<int> spawn_begin;   // spawn_rows range of stage s: [spawn_begin[s], spawn_begin[s + 1])
+
+public:
+    void buildColumns(const std::vector<int> &stage_starts, int width); // Column -> stage table (before the grid is filled)
+    void buildCells(const Grid &map);                                   // Door and spawn tables (after the grid is filled), validates the columns
+
+    int stageCount() const { return static_cast<int>(stage_indices.size()); }
+    const std::vector<int> &stageStarts() const { return stage_indices; }
+    int stageStart(int stage) const { return stage_indices[stage]; }
+    int stageOf(int w) const // Stage containing column w
+    {
+        if constexpr (CHECKED_BUILD)
+        {
+            if (w < 0 || w >= static_cast<int>(column_stage.size()) || column_stage[w] < 0)
+            {
+                throw std::runtime_error("Invalid stage index: " + std::to_string(w)); // Error if no valid stage found
+            }
+        }
+        return column_stage[w]; // buildCells guarantees a stage for every column an entity can be in
+    }
+
+    // Rows of the doors that `stage` opens (they sit in the start column of stage + 1)
+    const int *doorsBegin(int stage) const { return door_rows.data() + door_begin[stage]; }
+    const int *doorsEnd(int stage) const { return door_rows.data() + door_begin[stage + 1]; }
+    // Rows of the start column of `stage` that a respawn may use (walls never change)
+    const int *spawnBegin(int stage) const { return spawn_rows.data() + spawn_begin[stage]; }
+    const int *spawnEnd(int stage) const { return spawn_rows.data() + spawn_begin[stage + 1]; }
+};
+
+#endif // MAP_INDEX_H
@@ -19,31 +19,21 @@ void Player::getPos(int &h, int &w) const
     w = pos[1]; // Get the y-coordinate of the player
 }
 
-int Player::getStage(int w, const vector<int> &stage_indices)
-{
-    for (size_t i{0}; i < stage_indices.size(); i++)
-    {
-        if (w >= stage_indices.at(i) && (i + 1 >= stage_indices.size() || w < stage_indices.at(i + 1)))
-        {
-            return i; // Return the stage number
-        }
-    }
-    throw std::runtime_error("Invalid stage index for w: " + std::to_string(w)); // Error if no valid stage found
-}
-
-void Player::respawn(vector<vector<char>> &map, const vector<int> &stage_indices)
+void Player::respawn(Grid &map, const MapIndex &index)
 {
     int w, h;
-    getPos(h, w);                           // Get the player's position
-    int stage = getStage(w, stage_indices); // Get the stage number
-    bool respawn_flag = false;              // Flag for respawn
-    for (size_t i{0}; i < map.size(); i++)
+    getPos(h, w);                          // Get the player's position
+    int stage = index.stageOf(w);          // Get the stage number
+    int spawn_w = index.stageStart(stage); // Respawn column (start of the stage)
+    bool respawn_flag = false;             // Flag for respawn
+    // Only rows that were not walls at load time can be empty; the last empty one wins
+    for (const int *row = index.spawnBegin(stage); row != index.spawnEnd(stage); row++)
     {
-        if (map.at(i).at(stage_indices[stage]) == ' ')
+        if (map(*row, spawn_w) == ' ')
         {
-            direction = '>';                                // Reset the direction to right
-            map.at(i).at(stage_indices[stage]) = direction; // Respawn the player at the end position
-            setPos(i, stage_indices[stage]);                // Update the player's position
+            direction = '>';                   // Reset the direction to right
+            map.set(*row, spawn_w, direction); // Respawn the player at the end position
+            setPos(*row, spawn_w);             // Update the player's position
             respawn_flag = true;
         }
     }
@@ -5,6 +5,9 @@
 #include <iostream>
 #include <array>
 
+#include "grid.h"
+#include "map_index.h"
+
 class Player
 {
     std::array<int, 2> pos{-1, -1}; // Player position (h, w)
@@ -17,10 +20,9 @@ public:
     void getPos(int &, int &) const;                                             // Get the player's position
     void setDirection(char d) { direction = d; }                                 // Set the player's direction
     char getDirection() const { return direction; }                              // Get the player's direction
-    int getW() { return pos[1]; }                                                // Get the player's w coordinate
-    int getH() { return pos[0]; }                                                // Get the player's h coordinate
-    void respawn(std::vector<std::vector<char>> &map, const std::vector<int> &); // Respawn the player
-    int getStage(int w, const std::vector<int> &stage_indices);                  // Get the stage number based on w coordinate
+    int getW() const { return pos[1]; }                                               // Get the player's w coordinate
+    int getH() const { return pos[0]; }                                               // Get the player's h coordinate
+    void respawn(Grid &map, const MapIndex &);                                   // Respawn the player
 };
 
 #endif // PLAYER_H
\ No newline at end of file
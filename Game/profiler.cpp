@@ -0,0 +1,103 @@
+#include "profiler.h"
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+using std::endl;
+using std::ostream;
+using std::setw;
+using std::string;
+
+namespace
+{
+    const char *POINT_NAMES[] = {"getNextMove", "advanceGameCycle", "checkEnemies", "getGameState:vision", "getGameState:display"};
+}
+
+int LatencyHistogram::bucketOf(uint64_t ns)
+{
+    if (ns < SUB_BUCKETS)
+        return static_cast<int>(ns); // Exact below the first power of two that gets split
+    int exponent = std::bit_width(ns) - 1;                                  // >= SUB_BITS
+    int sub = static_cast<int>((ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1));
+    return std::min((exponent - SUB_BITS + 1) * SUB_BUCKETS + sub, BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::bucketValue(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << (exponent - SUB_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns)
+{
+    buckets[bucketOf(ns)]++;
+    total++;
+    longest = std::max(longest, ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (int i{0}; i < BUCKETS; i++)
+    {
+        buckets[i] += other.buckets[i];
+    }
+    total += other.total;
+    longest = std::max(longest, other.longest);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    if (total == 0)
+        return 0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * total + 0.5)); // Nearest-rank
+    uint64_t seen{0};
+    for (int i{0}; i < BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(bucketValue(i), longest);
+    }
+    return longest;
+}
+
+void Profiler::record(ProfilePoint point, int stage, uint64_t ns)
+{
+    if (stage < 0)
+        stage = 0;
+    if (static_cast<size_t>(stage) >= stages.size())
+        stages.resize(stage + 1);
+    stages[stage][static_cast<size_t>(point)].record(ns);
+}
+
+void Profiler::report(ostream &out) const
+{
+    // One block per call site: the totals over all stages first, then every stage that saw the call
+    out << std::left << setw(22) << "latency (ns)" << std::right << setw(7) << "stage" << setw(10) << "calls"
+        << setw(10) << "p50" << setw(10) << "p99" << setw(12) << "max" << endl;
+    auto line = [&out](const char *name, const string &stage, const LatencyHistogram &histogram)
+    {
+        out << std::left << setw(22) << name << std::right << setw(7) << stage << setw(10) << histogram.count()
+            << setw(10) << histogram.percentile(50) << setw(10) << histogram.percentile(99) << setw(12) << histogram.max() << endl;
+    };
+    for (size_t point{0}; point < static_cast<size_t>(ProfilePoint::COUNT); point++)
+    {
+        LatencyHistogram all;
+        for (const auto &stage : stages)
+        {
+            all.merge(stage[point]);
+        }
+        if (all.count() == 0)
+            continue;
+        line(POINT_NAMES[point], "all", all);
+        for (size_t s{0}; s < stages.size(); s++)
+        {
+            if (stages[s][point].count() > 0)
+                line("", std::to_string(s), stages[s][point]);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// Latency histogram with logarithmic buckets: every power of two of
+// nanoseconds is split into 2^SUB_BITS linear sub-buckets, so percentiles are
+// within ~12% while a histogram stays small enough to keep one per stage.
+class LatencyHistogram
+{
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (40 - SUB_BITS + 1) * SUB_BUCKETS; // Up to ~2^40 ns (18 minutes)
+    std::array<uint32_t, BUCKETS> buckets{};
+    uint64_t total{0};   // Recorded samples
+    uint64_t longest{0}; // Largest sample (exact)
+
+    static int bucketOf(uint64_t ns);
+    static uint64_t bucketValue(int bucket); // Upper bound of a bucket
+
+public:
+    void record(uint64_t ns);
+    void merge(const LatencyHistogram &other);
+    uint64_t count() const { return total; }
+    uint64_t max() const { return longest; }
+    uint64_t percentile(double p) const; // p in [0, 100], 0 when empty
+};
+
+enum class ProfilePoint : uint8_t
+{
+    GET_NEXT_MOVE,  // Brain::getNextMove
+    ADVANCE_CYCLE,  // Game::advanceGameCycle (includes CHECK_ENEMIES)
+    CHECK_ENEMIES,  // Game::checkEnemies
+    GET_VISION,     // Game::getGameState, filling the state and the vision window
+    DISPLAY,        // Game::getGameState, visual output
+    COUNT
+};
+
+// Per stage latency histograms of the hot calls of a game. Opt-in: code
+// holds a Profiler pointer that is null unless profiling was requested, and a
+// ProfileScope on a null profiler does not even read the clock.
+class Profiler
+{
+    using Histograms = std::array<LatencyHistogram, static_cast<size_t>(ProfilePoint::COUNT)>;
+    std::vector<Histograms> stages; // Grows to the highest stage recorded
+
+public:
+    void record(ProfilePoint point, int stage, uint64_t ns);
+    void report(std::ostream &out) const; // Table of count/p50/p99/max per stage and over all stages
+};
+
+class ProfileScope
+{
+    Profiler *profiler;
+    ProfilePoint point;
+    int stage;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ProfileScope(Profiler *profiler, ProfilePoint point, int stage) : profiler(profiler), point(point), stage(stage)
+    {
+        if (profiler)
+            start = std::chrono::steady_clock::now();
+    }
+    ~ProfileScope()
+    {
+        if (profiler)
+            profiler->record(point, stage, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,72 @@
+#include "render_thread.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <unistd.h>
+
+using std::chrono::steady_clock;
+
+RenderThread::RenderThread(int fps, int map_rows, int map_cols)
+    : view_rows(map_rows), view_cols(map_cols), fps(std::max(1, fps))
+{
+    updateView();
+    worker = std::thread(&RenderThread::run, this);
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::stop()
+{
+    if (!worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_signal.notify_one();
+    worker.join();
+}
+
+void RenderThread::updateView()
+{
+    int rows, cols;
+    if (TerminalRenderer::windowSize(STDOUT_FILENO, rows, cols))
+    {
+        view_rows = std::max(1, rows - 3); // Status line, stage markers and the cursor line
+        view_cols = cols;
+    }
+}
+
+void RenderThread::run()
+{
+    const auto period = std::chrono::microseconds(1000000 / fps);
+    auto next = steady_clock::now();
+    bool last = false;
+    while (true)
+    {
+        try
+        {
+            if (mailbox.consume())
+                renderer.draw(mailbox.readBuffer());
+        }
+        catch (const std::exception &error)
+        {
+            failure = error.what(); // Kept for Game::stopRendering; the simulation carries on without frames
+            failed.store(true, std::memory_order_release);
+            return;
+        }
+        if (last)
+            return;
+        updateView();
+        next += period;
+        auto now = steady_clock::now();
+        if (next < now)
+            next = now; // Fell behind (slow terminal): skip the missed ticks instead of bursting
+        std::unique_lock<std::mutex> lock(stop_mutex);
+        last = stop_signal.wait_until(lock, next, [this]
+                                      { return stopping; }); // One more pass picks up the final frame
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "renderer.h"
+
+// Triple buffer handing frames from one producer to one consumer. The producer
+// fills writeBuffer() and publishes it; the consumer picks up the newest
+// published frame. Neither side ever waits for the other, and frames published
+// while the consumer is busy are simply replaced by newer ones.
+class FrameMailbox
+{
+    static constexpr uint8_t FRESH = 4; // Set in `middle` when it holds a frame the consumer has not taken
+    std::array<Frame, 3> buffers;
+    std::atomic<uint8_t> middle{0}; // Buffer index being handed over (| FRESH)
+    uint8_t back{1};                // Producer's buffer
+    uint8_t front{2};               // Consumer's buffer
+
+public:
+    Frame &writeBuffer() { return buffers[back]; }
+    void publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & 3; }
+    bool consume() // Swaps in the newest frame, false if nothing new was published
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+    const Frame &readBuffer() const { return buffers[front]; }
+};
+
+// Draws published frames on a thread of its own at a fixed frame rate, so the
+// simulation only pays for filling a frame and never for terminal output.
+class RenderThread
+{
+    FrameMailbox mailbox;
+    TerminalRenderer renderer;
+    std::atomic<int> view_rows; // Window size the next frames should have (tracks the terminal)
+    std::atomic<int> view_cols;
+    std::mutex stop_mutex;         // Only used to cut the frame wait short on shutdown
+    std::condition_variable stop_signal;
+    bool stopping{false};          // Guarded by stop_mutex
+    int fps;
+    std::atomic<bool> failed{false}; // Set when a draw threw: the worker has stopped drawing
+    std::string failure;             // Why, written by the worker before it sets `failed`
+    std::thread worker;
+
+private:
+    void run();         // Render loop
+    void updateView();  // Re-reads the terminal size
+
+public:
+    RenderThread(int fps, int map_rows, int map_cols); // Starts drawing; map size is the window when stdout is no tty
+    ~RenderThread();                                   // Same as stop()
+    void stop();                                       // Draws the last published frame and joins (once)
+    RenderThread(const RenderThread &) = delete;
+    RenderThread &operator=(const RenderThread &) = delete;
+
+    int viewRows() const { return view_rows.load(std::memory_order_relaxed); }
+    int viewCols() const { return view_cols.load(std::memory_order_relaxed); }
+    Frame &nextFrame() { return mailbox.writeBuffer(); } // Frame to fill before publish()
+    void publish() { mailbox.publish(); }                // Hands the filled frame over, never blocks
+    bool hasFailed() const { return failed.load(std::memory_order_acquire); } // Frames are no longer drawn
+    const std::string &error() const { return failure; } // Why drawing stopped, read once hasFailed() (empty otherwise)
+};
+
+#endif // RENDER_THREAD_H
@@ -0,0 +1,95 @@
+#include "renderer.h"
+#include <cerrno>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+using std::string;
+
+TerminalRenderer::TerminalRenderer(int fd) : fd(fd)
+{
+}
+
+bool TerminalRenderer::windowSize(int fd, int &rows, int &cols)
+{
+    winsize size{};
+    if (!isatty(fd) || ioctl(fd, TIOCGWINSZ, &size) != 0 || size.ws_row == 0 || size.ws_col == 0)
+        return false;
+    rows = size.ws_row;
+    cols = size.ws_col;
+    return true;
+}
+
+void TerminalRenderer::moveCursor(int row, int col)
+{
+    out += "\033[";
+    out += std::to_string(row);
+    out += ';';
+    out += std::to_string(col);
+    out += 'H';
+}
+
+void TerminalRenderer::flush()
+{
+    const char *data = out.data();
+    size_t left = out.size();
+    while (left > 0)
+    {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("Could not write frame to the terminal");
+        }
+        data += written;
+        left -= written;
+    }
+    out.clear();
+}
+
+void TerminalRenderer::draw(const Frame &frame)
+{
+    // Screen layout: status on line 1, stage markers on line 2, map rows from line 3
+    out.clear();
+    bool full = !valid || frame.rows != shown.rows || frame.cols != shown.cols;
+    if (full)
+    {
+        out += "\033[2J\033[H";
+        out += frame.status;
+        for (int r{0}; r <= frame.rows; r++)
+        {
+            moveCursor(r + 2, 1);
+            out.append(&frame.cells[static_cast<size_t>(r) * frame.cols], frame.cols);
+        }
+    }
+    else
+    {
+        if (frame.status != shown.status)
+        {
+            moveCursor(1, 1);
+            out += frame.status;
+            out += "\033[K"; // The old line may have been longer
+        }
+        for (int r{0}; r <= frame.rows; r++)
+        {
+            const char *now = &frame.cells[static_cast<size_t>(r) * frame.cols];
+            const char *before = &shown.cells[static_cast<size_t>(r) * frame.cols];
+            for (int c{0}; c < frame.cols; c++)
+            {
+                if (now[c] == before[c])
+                    continue;
+                int run = c;
+                while (run < frame.cols && now[run] != before[run])
+                    run++;
+                moveCursor(r + 2, c + 1);
+                out.append(now + c, run - c);
+                c = run;
+            }
+        }
+    }
+    moveCursor(frame.rows + 3, 1); // Park the cursor below the map
+    flush();
+    shown = frame;
+    valid = true;
+}
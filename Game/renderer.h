@@ -0,0 +1,40 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <string>
+#include <vector>
+
+// One screen of the game: the status line, the stage marker row and the part of
+// the map that fits the terminal (fog already applied). Filled by Game::fillFrame.
+struct Frame
+{
+    std::string status;      // "Stage: .. Score: .. Moves: .."
+    int top{0};              // Map row shown on the first map line
+    int left{0};             // Map column shown in the first screen column
+    int rows{0};             // Map rows in the window
+    int cols{0};             // Map columns in the window
+    std::vector<char> cells; // (rows + 1) x cols: the stage markers, then the map rows
+};
+
+// Draws frames to a terminal file descriptor. The previous frame is kept, so
+// each draw only emits the screen cells that changed, addressed with cursor
+// escapes, and the whole update goes out in a single write().
+class TerminalRenderer
+{
+    int fd;
+    Frame shown;        // What is on the screen right now
+    bool valid{false};  // False until the first full draw (or after invalidate)
+    std::string out;    // Escape buffer, reused between frames
+
+private:
+    void moveCursor(int row, int col); // Appends a 1-based cursor positioning escape
+    void flush();                      // Writes the buffer out, retrying partial writes
+
+public:
+    explicit TerminalRenderer(int fd = 1);
+    static bool windowSize(int fd, int &rows, int &cols); // Terminal size through TIOCGWINSZ (false if fd is no tty)
+    void draw(const Frame &);                             // Brings the screen up to date with the frame
+    void invalidate() { valid = false; }                  // Forces a full redraw on the next frame
+};
+
+#endif // RENDERER_H
@@ -0,0 +1,227 @@
+#include "replay.h"
+#include "game.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    void putWord(vector<char> &out, uint32_t value)
+    {
+        const char *bytes = reinterpret_cast<const char *>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(value));
+    }
+
+    // Runs of bytes where `state` differs from `base` (both the same size)
+    vector<char> encodeDelta(const vector<char> &base, const vector<char> &state)
+    {
+        vector<char> runs;
+        size_t i{0};
+        while (i < state.size())
+        {
+            if (state[i] == base[i])
+            {
+                i++;
+                continue;
+            }
+            size_t end = i;
+            while (end < state.size() && state[end] != base[end])
+                end++;
+            putWord(runs, i);
+            putWord(runs, end - i);
+            runs.insert(runs.end(), state.begin() + i, state.begin() + end);
+            i = end;
+        }
+        return runs;
+    }
+
+    vector<char> applyDelta(const vector<char> &base, const vector<char> &runs)
+    {
+        vector<char> state = base;
+        size_t i{0};
+        while (i + 2 * sizeof(uint32_t) <= runs.size())
+        {
+            uint32_t offset, length;
+            std::memcpy(&offset, runs.data() + i, sizeof(offset));
+            std::memcpy(&length, runs.data() + i + sizeof(offset), sizeof(length));
+            i += 2 * sizeof(uint32_t);
+            if (i + length > runs.size() || static_cast<size_t>(offset) + length > state.size())
+                throw std::runtime_error("Corrupt replay keyframe");
+            std::memcpy(state.data() + offset, runs.data() + i, length);
+            i += length;
+        }
+        return state;
+    }
+}
+
+ReplayRecorder::ReplayRecorder(const string &map_path, int keyframe_interval)
+    : map_path(map_path), keyframe_interval(std::max(keyframe_interval, 1))
+{
+}
+
+void ReplayRecorder::record(const Game &game, int action)
+{
+    if (actions.empty())
+    {
+        map_hash = game.stateHash(); // The first recorded state is the freshly loaded map
+    }
+    if (game.getCycle() % keyframe_interval == 0)
+    {
+        keyframe_cycles.push_back(game.getCycle());
+        keyframes.emplace_back();
+        game.saveState(keyframes.back());
+    }
+    actions.push_back(static_cast<uint8_t>(action));
+}
+
+void ReplayRecorder::save(const string &path) const
+{
+    ReplayHeader header{};
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_VERSION;
+    header.map_hash = map_hash;
+    header.keyframe_interval = keyframe_interval;
+    header.action_count = actions.size();
+    header.keyframe_count = keyframes.size();
+    header.path_length = map_path.size();
+
+    vector<uint8_t> packed((actions.size() + 1) / 2, 0);
+    for (size_t i{0}; i < actions.size(); i++)
+    {
+        packed[i / 2] |= (actions[i] & 0x0F) << ((i % 2) * 4); // Actions are 0..4, a nibble each
+    }
+
+    vector<vector<char>> blobs(keyframes.size());
+    vector<ReplayKeyframe> index(keyframes.size());
+    uint64_t offset = sizeof(header) + map_path.size() + packed.size() + sizeof(ReplayKeyframe) * index.size();
+    for (size_t i{0}; i < keyframes.size(); i++)
+    {
+        bool delta = i > 0 && keyframes[i].size() == keyframes[0].size();
+        blobs[i] = delta ? encodeDelta(keyframes[0], keyframes[i]) : keyframes[i];
+        index[i] = ReplayKeyframe{keyframe_cycles[i], static_cast<uint32_t>(blobs[i].size()), offset, delta, 0};
+        offset += blobs[i].size();
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(map_path.data(), map_path.size());
+    out.write(reinterpret_cast<const char *>(packed.data()), packed.size());
+    out.write(reinterpret_cast<const char *>(index.data()), sizeof(ReplayKeyframe) * index.size());
+    for (const auto &blob : blobs)
+    {
+        out.write(blob.data(), blob.size());
+    }
+    if (!out)
+    {
+        throw std::runtime_error("Could not write replay log: " + path);
+    }
+}
+
+ReplayLog::ReplayLog(const string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+    {
+        throw std::runtime_error("Could not open replay log: " + path);
+    }
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0 || header.version != REPLAY_VERSION)
+    {
+        throw std::runtime_error("Not a replay log: " + path);
+    }
+    map_path.resize(header.path_length);
+    in.read(map_path.data(), map_path.size());
+
+    vector<uint8_t> packed((header.action_count + 1) / 2);
+    in.read(reinterpret_cast<char *>(packed.data()), packed.size());
+    actions.resize(header.action_count);
+    for (size_t i{0}; i < actions.size(); i++)
+    {
+        actions[i] = (packed[i / 2] >> ((i % 2) * 4)) & 0x0F;
+    }
+
+    std::streamoff index_start = in.tellg();
+    in.seekg(0, std::ios::end);
+    uint64_t file_size = in.tellg();
+    in.seekg(index_start);
+    if (!in || sizeof(ReplayKeyframe) * static_cast<uint64_t>(header.keyframe_count) > file_size)
+    {
+        throw std::runtime_error("Corrupt replay log: " + path);
+    }
+    index.resize(header.keyframe_count);
+    in.read(reinterpret_cast<char *>(index.data()), sizeof(ReplayKeyframe) * index.size());
+    for (size_t i{0}; i < index.size(); i++)
+    {
+        // seek() binary-searches the cycles and steps forward from a keyframe, so they must be sorted and recorded
+        const ReplayKeyframe &keyframe = index[i];
+        if ((i > 0 && keyframe.cycle <= index[i - 1].cycle) || keyframe.cycle > header.action_count ||
+            keyframe.offset > file_size || keyframe.size > file_size - keyframe.offset)
+        {
+            throw std::runtime_error("Corrupt replay log: " + path);
+        }
+    }
+    for (const auto &keyframe : index)
+    {
+        blobs.emplace_back(keyframe.size);
+        in.seekg(keyframe.offset);
+        in.read(blobs.back().data(), keyframe.size);
+        bool first = blobs.size() == 1;
+        if (!in || (first && (keyframe.cycle != 0 || keyframe.delta))) // The first keyframe is the full initial state
+        {
+            throw std::runtime_error("Corrupt replay log: " + path);
+        }
+        if (keyframe.delta)
+        {
+            blobs.back() = applyDelta(blobs.front(), blobs.back()); // Expand once, seeks then copy whole states
+        }
+    }
+    if (!in || index.empty())
+    {
+        throw std::runtime_error("Corrupt replay log: " + path);
+    }
+}
+
+void ReplayLog::seek(Game &game, int cycle) const
+{
+    if (cycle < 0 || cycle > cycles())
+    {
+        throw std::runtime_error("Replay has no cycle " + std::to_string(cycle));
+    }
+    // Keyframes are sorted by cycle: take the last one at or before the target
+    auto keyframe = std::upper_bound(index.begin(), index.end(), static_cast<uint32_t>(cycle),
+                                     [](uint32_t value, const ReplayKeyframe &entry)
+                                     { return value < entry.cycle; }) -
+                    1;
+    if (game.getCycle() > cycle || game.getCycle() < static_cast<int>(keyframe->cycle))
+    {
+        game.loadState(blobs[keyframe - index.begin()]); // Stepping forward from the current state is cheaper otherwise
+    }
+    while (game.getCycle() < cycle)
+    {
+        game.advanceGameCycle(actions[game.getCycle()]);
+    }
+}
+
+int ReplayLog::replay(Game &game) const
+{
+    vector<char> state;
+    size_t next_keyframe{0};
+    while (true)
+    {
+        if (next_keyframe < index.size() && static_cast<int>(index[next_keyframe].cycle) == game.getCycle())
+        {
+            game.saveState(state);
+            if (state != blobs[next_keyframe])
+                return game.getCycle(); // The engine no longer reproduces the recording
+            next_keyframe++;
+        }
+        if (game.getCycle() >= cycles())
+            return -1;
+        game.advanceGameCycle(actions[game.getCycle()]);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+// Replay log format (.mzr), integers in host byte order:
+//   ReplayHeader, map path bytes
+//   actions, two per byte (low nibble first)
+//   ReplayKeyframe[keyframe_count]   keyframe index
+//   keyframe blobs
+// The keyframe at cycle 0 is the initial state (a full Game::saveState blob);
+// one follows every keyframe_interval cycles, so seeking re-simulates at most
+// that many cycles. Later keyframes are stored as runs of the bytes that differ
+// from the first one ({u32 offset, u32 length, bytes}...), which keeps logs of
+// large maps small since only a few cells change per episode.
+constexpr char REPLAY_MAGIC[4] = {'M', 'Z', 'R', 'P'};
+constexpr uint32_t REPLAY_VERSION = 1;
+
+struct ReplayHeader
+{
+    char magic[4];              // REPLAY_MAGIC
+    uint32_t version;           // REPLAY_VERSION
+    uint64_t map_hash;          // Game::stateHash of the freshly loaded map
+    uint32_t keyframe_interval; // Cycles between keyframes
+    uint32_t action_count;      // Recorded cycles
+    uint32_t keyframe_count;    // Entries in the keyframe index
+    uint32_t path_length;       // Bytes of the map path that follow the header
+};
+
+struct ReplayKeyframe
+{
+    uint32_t cycle;  // Cycle the state belongs to (before its action is applied)
+    uint32_t size;   // Stored blob size
+    uint64_t offset; // Blob offset from the start of the file
+    uint32_t delta;  // 1 if the blob holds runs against the first keyframe, 0 if it is a full state
+    uint32_t reserved;
+};
+
+// Collects the actions of one episode and a full state every keyframe_interval cycles
+class ReplayRecorder
+{
+    std::string map_path;
+    uint64_t map_hash{0};
+    int keyframe_interval{100};
+    std::vector<uint8_t> actions;            // One action per cycle (packed on save)
+    std::vector<uint32_t> keyframe_cycles;   // Cycle of each keyframe
+    std::vector<std::vector<char>> keyframes; // Game::saveState blobs
+
+public:
+    ReplayRecorder(const std::string &map_path, int keyframe_interval);
+    void record(const Game &game, int action); // Call right before game.advanceGameCycle(action)
+    void save(const std::string &path) const;   // Writes the log file
+};
+
+// A loaded replay log that can put a Game into the state of any recorded cycle
+class ReplayLog
+{
+    ReplayHeader header{};
+    std::string map_path;
+    std::vector<uint8_t> actions;          // Unpacked, one per cycle
+    std::vector<ReplayKeyframe> index;     // Keyframe index
+    std::vector<std::vector<char>> blobs;  // Keyframe states
+
+public:
+    explicit ReplayLog(const std::string &path); // Loads and validates the log, throws std::runtime_error
+    const std::string &mapPath() const { return map_path; }
+    uint64_t mapHash() const { return header.map_hash; }
+    int cycles() const { return actions.size(); }
+    int actionAt(int cycle) const { return actions[cycle]; }
+    void seek(Game &game, int cycle) const; // Restores the closest keyframe at or before cycle and re-simulates
+    int replay(Game &game) const;           // Re-simulates a fresh game to the end; first keyframe that differs or -1
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,98 @@
+#ifndef TILES_H
+#define TILES_H
+
+#include <array>
+#include <cstdint>
+
+// Per-tile property bits, derived from the tile character
+enum TileFlag : uint8_t
+{
+    TILE_EMPTY = 1 << 0,       // ' '   free cell (enemies only move into these)
+    TILE_WALL = 1 << 1,        // '+'   blocks everything, enemies bounce off it
+    TILE_WALKABLE = 1 << 2,    // cells the player can step onto (' ', '0', 'A', 'B', 'w')
+    TILE_LETHAL = 1 << 3,      // 'T', 'X' respawn the player
+    TILE_COLLECTIBLE = 1 << 4, // '0', 'A', 'B' change score or stage state
+    TILE_DOOR = 1 << 5,        // 'D'   closed door
+    TILE_GOAL = 1 << 6,        // 'w'   ends the game
+};
+
+// What happens to the player who tries to enter a tile
+enum class MoveOutcome : uint8_t
+{
+    Block, // Stays put (only turns to face the tile)
+    Step,  // Moves onto the tile
+    Die,   // Leaves the board and respawns at the start of the stage
+    Stay,  // Stays put, the tile's effect still applies (the goal)
+};
+
+// Stage flag state the outcome depends on; when it does not hold the tile blocks
+enum class TileCondition : uint8_t
+{
+    Always,
+    FlagNotPicked, // The stage's 'A' has not been picked yet
+    FlagPicked,    // The stage's 'A' has been picked
+};
+
+// Stage bookkeeping done by Game after the move (see Game::applyTileEffect)
+enum class TileEffect : uint8_t
+{
+    None,
+    EatFood,   // One food less in the stage; the last one opens a door
+    PickFlag,  // Marks the stage's 'A' as picked
+    PlaceFlag, // Marks the stage's 'B' as placed and opens a door
+    ReachGoal, // Adds the unused cycles to the score and wins the game
+};
+
+struct TileKind
+{
+    char glyph;              // Tile byte in the map
+    uint8_t flags;           // TileFlag bits (the Grid keeps these in its flag plane)
+    MoveOutcome outcome;     // Result of entering the tile
+    TileCondition condition; // Outcome only applies when this holds
+    int16_t score;           // Score gained by entering it
+    TileEffect effect;       // Bookkeeping after entering it
+};
+
+// The tile registry: a new kind of tile is one more entry here (plus a TileEffect if it needs new bookkeeping)
+inline constexpr TileKind TILE_KINDS[] = {
+    {' ', TILE_EMPTY | TILE_WALKABLE, MoveOutcome::Step, TileCondition::Always, 0, TileEffect::None},
+    {'+', TILE_WALL, MoveOutcome::Block, TileCondition::Always, 0, TileEffect::None},
+    {'D', TILE_DOOR, MoveOutcome::Block, TileCondition::Always, 0, TileEffect::None},
+    {'0', TILE_WALKABLE | TILE_COLLECTIBLE, MoveOutcome::Step, TileCondition::Always, 1, TileEffect::EatFood},
+    {'A', TILE_WALKABLE | TILE_COLLECTIBLE, MoveOutcome::Step, TileCondition::FlagNotPicked, 10, TileEffect::PickFlag},
+    {'B', TILE_WALKABLE | TILE_COLLECTIBLE, MoveOutcome::Step, TileCondition::FlagPicked, 15, TileEffect::PlaceFlag},
+    {'T', TILE_LETHAL, MoveOutcome::Die, TileCondition::Always, 0, TileEffect::None},
+    {'X', TILE_LETHAL, MoveOutcome::Die, TileCondition::Always, 0, TileEffect::None},
+    {'w', TILE_WALKABLE | TILE_GOAL, MoveOutcome::Stay, TileCondition::Always, 1000, TileEffect::ReachGoal},
+};
+
+// Unregistered bytes (players, stray characters) block without side effects
+constexpr std::array<TileKind, 256> makeTileTable()
+{
+    std::array<TileKind, 256> table{};
+    for (int c{0}; c < 256; c++)
+    {
+        table[c] = {static_cast<char>(c), 0, MoveOutcome::Block, TileCondition::Always, 0, TileEffect::None};
+    }
+    for (const TileKind &kind : TILE_KINDS)
+    {
+        table[static_cast<unsigned char>(kind.glyph)] = kind;
+    }
+    return table;
+}
+
+inline constexpr std::array<TileKind, 256> TILE_TABLE = makeTileTable(); // Tile kind of every tile byte
+
+constexpr std::array<uint8_t, 256> makeTileFlagTable()
+{
+    std::array<uint8_t, 256> table{};
+    for (int c{0}; c < 256; c++)
+    {
+        table[c] = TILE_TABLE[c].flags;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> TILE_FLAGS = makeTileFlagTable(); // Flags of every tile byte (dense copy for the Grid)
+
+#endif // TILES_H
@@ -0,0 +1,103 @@
+#include "tracer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using std::chrono::steady_clock;
+
+std::atomic<bool> Tracer::on{false};
+
+namespace
+{
+    struct ThreadBuffer
+    {
+        uint32_t tid;                   // Small sequential id, in order of the first span
+        std::vector<TraceEvent> events; // Only ever touched by its own thread until the trace is written
+    };
+
+    struct TraceLog
+    {
+        std::mutex mutex; // Guards threads (registration and writing only)
+        std::vector<std::unique_ptr<ThreadBuffer>> threads;
+        std::string path;
+        steady_clock::time_point origin;
+    };
+
+    TraceLog &traceLog()
+    {
+        static TraceLog log; // Built before the exit handler is registered, so it outlives it
+        return log;
+    }
+
+    thread_local ThreadBuffer *local_buffer = nullptr;
+
+    void writeAtExit()
+    {
+        TraceLog &log = traceLog();
+        std::ofstream out(log.path);
+        Tracer::write(out);
+        if (!out)
+            std::cerr << "Error: could not write the trace to " << log.path << std::endl;
+    }
+}
+
+void Tracer::start(const std::string &path)
+{
+    TraceLog &log = traceLog();
+    log.path = path;
+    log.origin = steady_clock::now();
+    std::atexit(writeAtExit);
+    on.store(true, std::memory_order_release);
+}
+
+uint64_t Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - traceLog().origin).count();
+}
+
+void Tracer::record(const TraceEvent &event)
+{
+    if (!local_buffer)
+    {
+        TraceLog &log = traceLog();
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->events.reserve(1 << 14); // A few thousand cycles before the first regrowth
+        std::lock_guard<std::mutex> lock(log.mutex);
+        buffer->tid = static_cast<uint32_t>(log.threads.size() + 1);
+        local_buffer = buffer.get();
+        log.threads.push_back(std::move(buffer)); // Owned by the log, so it outlives its thread
+    }
+    local_buffer->events.push_back(event);
+}
+
+void Tracer::write(std::ostream &out)
+{
+    TraceLog &log = traceLog();
+    std::lock_guard<std::mutex> lock(log.mutex);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    out << std::fixed << std::setprecision(3);
+    for (const auto &thread : log.threads)
+    {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid
+            << ",\"args\":{\"name\":\"thread " << thread->tid << "\"}}";
+        first = false;
+        for (const TraceEvent &event : thread->events)
+        {
+            // Timestamps are in microseconds; three decimals keep the nanoseconds
+            out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"maze\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->tid
+                << ",\"ts\":" << event.start_ns / 1000.0 << ",\"dur\":" << event.duration_ns / 1000.0 << ",\"args\":{";
+            if (event.stage >= 0)
+                out << "\"stage\":" << event.stage;
+            if (event.state >= 0)
+                out << (event.stage >= 0 ? "," : "") << "\"state\":" << event.state;
+            out << "}}";
+        }
+    }
+    out << "\n]}\n";
+}
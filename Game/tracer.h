@@ -0,0 +1,66 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// One finished span: a Chrome trace "complete" event
+struct TraceEvent
+{
+    const char *name;     // Static string, e.g. "Game::checkEnemies"
+    uint64_t start_ns;    // Since the tracer started
+    uint64_t duration_ns;
+    int32_t stage;        // Stage of the player (-1 = none)
+    int32_t state;        // FSM state of the stage script (-1 = none)
+};
+
+// Process wide span recorder writing Chrome/Perfetto trace-event JSON. Opt-in:
+// until start() is called a TraceScope is one relaxed load and never reads the
+// clock. Every thread appends to a buffer of its own, so recording takes no
+// lock after a thread's first span; the file is written when the program exits.
+class Tracer
+{
+    static std::atomic<bool> on;
+
+public:
+    static bool enabled() { return on.load(std::memory_order_relaxed); }
+    static void start(const std::string &path); // Starts recording, the trace is written to path at exit
+    static uint64_t now();                       // Nanoseconds since start()
+    static void record(const TraceEvent &);      // Appends to the calling thread's buffer
+    static void write(std::ostream &);           // Every buffered span as trace-event JSON
+};
+
+class TraceScope
+{
+    TraceEvent event;
+    const int *state{nullptr};
+
+public:
+    explicit TraceScope(const char *name, int stage = -1) : event{name, 0, 0, stage, -1}
+    {
+        if (Tracer::enabled())
+            event.start_ns = Tracer::now();
+        else
+            event.name = nullptr; // Off: nothing to record when the scope ends
+    }
+    ~TraceScope()
+    {
+        if (event.name)
+        {
+            event.duration_ns = Tracer::now() - event.start_ns;
+            if (state)
+                event.state = *state;
+            Tracer::record(event);
+        }
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    void setStage(int stage) { event.stage = stage; }
+    void watchState(const int *fsm_state) { state = fsm_state; } // Tagged with its value when the span ends
+};
+
+#endif // TRACER_H
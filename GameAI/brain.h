@@ -3,25 +3,42 @@
 
 #include <string>
 #include "../Game/game.h"
+#include "strategy.h"
+#include "world_model.h"
 #include <cstdlib>
 #include <ctime>
 
+enum class BrainStrategy
+{
+    WorldModel,   // Shortest paths over everything seen so far (default)
+    StageScripts  // The original hand-written per-stage state machines
+};
+
 class Brain
 {
 private:
     bool flag_picked;       // Track if flag is picked in Stage 4
     int move_counter;       // Track the number of moves
     int current_stage;      // Track the current stage to reset move_counter
+    int highest_stage;      // Highest stage reached (prevents stage regression)
     int prev_move;          // Track previous move (1=up, 2=left, 3=down, 4=right)
     int prev_prev_move;     // Track move before previous move
-    bool right_blocked;
-    bool down_blocked;
+    bool A_is_encountered;  // Track if an 'A' flag has been seen next to the player
+    BrainStrategy strategy; // How moves are chosen
+    WorldModel world;       // Everything seen so far, merged from every vision window
+    Senses senses;          // Neighbourhood of the current cycle, read by the running stage script
+    StrategyFrame frame;    // Storage of the running stage script's coroutine frame
+    StageStrategy script;   // Script of the current stage (StageScripts only, started on its first move)
+    int script_phase;       // Part of the script that chose the last move (for traces)
 
     // Helper function to update movement history
     int updateMoveHistory(int move);
 
 public:
-    Brain();                               // Constructor
+    Brain(BrainStrategy strategy = BrainStrategy::WorldModel); // Constructor
+    Brain(const Brain &) = delete;            // The running script refers to senses and frame in place
+    Brain &operator=(const Brain &) = delete;
+    void reset();                          // Back to the state of a new brain, for the next episode
     int getNextMove(GameState &gamestate); // Returns the next move for the AI
 };
 
@@ -0,0 +1,183 @@
+#include "strategy.h"
+
+// The hand-written per-stage scripts. Each one used to be a state machine
+// re-entered on every call; as coroutines the state is simply where the code
+// is suspended. `phase` labels the part of the script that chose the last
+// move, for traces only.
+
+namespace {
+
+// Stage 0: climb, run right, then zigzag right and down
+StageStrategy stage0(const Senses &s, int &phase) {
+    for (;;) {
+        phase = 0; // Climb until blocked
+        while (s.open(UP))
+            co_yield UP;
+        phase = 1; // Run right until blocked
+        while (s.open(RIGHT))
+            co_yield RIGHT;
+
+        phase = 2; // Zigzag until a move up restarts the climb (right is known to be blocked from here)
+        bool down_blocked = false;
+        for (;;) {
+            if (s.prev_move == DOWN && s.open(RIGHT)) {
+                co_yield RIGHT; // Right after every step down
+                continue;
+            }
+            if (s.wall[DOWN])
+                down_blocked = true;
+            if (down_blocked) {
+                bool restart = s.prev_move != DOWN;
+                co_yield STAY; // Boxed in: wait, then climb again unless the last move was down
+                if (restart)
+                    break;
+                continue;
+            }
+            if (s.open(RIGHT) && !s.wall_up_right && s.prev_move != DOWN) {
+                if (s.direction != '>') {
+                    co_yield RIGHT; // Turn first
+                    continue;
+                }
+                co_yield UP; // Facing right under an open corner: climb from here
+                break;
+            }
+            if (s.open(RIGHT)) {
+                co_yield RIGHT;
+            } else if (s.open(DOWN)) {
+                co_yield DOWN;
+            } else {
+                bool restart = s.prev_move != DOWN;
+                co_yield STAY;
+                if (restart)
+                    break;
+            }
+        }
+    }
+}
+
+// Stage 1: sweep each column up and down, then step right (climbing to find an opening)
+StageStrategy stage1(const Senses &s, int &phase) {
+    for (;;) {
+        phase = 0; // Up until blocked
+        while (s.open(UP))
+            co_yield UP;
+        for (bool climb = false; !climb;) {
+            phase = 1; // Down until blocked
+            while (s.open(DOWN))
+                co_yield DOWN;
+            phase = 2; // Step right, back to the climb
+            if (s.open(RIGHT)) {
+                co_yield RIGHT;
+                break;
+            }
+            phase = 3; // Right is blocked: climb, stepping right at the first opening
+            for (;;) {
+                if (s.prev_move == UP && s.open(RIGHT)) {
+                    co_yield RIGHT;
+                    climb = true;
+                    break;
+                }
+                if (!s.open(UP)) {
+                    co_yield STAY; // Top reached: sweep down again
+                    break;
+                }
+                co_yield UP;
+            }
+        }
+    }
+}
+
+// Stage 2: run in one direction until blocked, then turn by a fixed priority
+StageStrategy stage2(const Senses &s, int &phase) {
+    struct Turns {
+        int count;
+        int to[3]; // Tried in order while open; the last one is taken even when blocked
+    };
+    static constexpr Turns TURNS[5] = {
+        {0, {}},                 // STAY (unused)
+        {3, {RIGHT, LEFT, DOWN}}, // After UP
+        {3, {UP, RIGHT, LEFT}},   // After LEFT: the last choice stays put
+        {2, {RIGHT, UP}},         // After DOWN
+        {3, {UP, DOWN, LEFT}},    // After RIGHT
+    };
+    int heading = RIGHT;
+    for (;;) {
+        phase = heading;
+        while (s.open(heading))
+            co_yield heading;
+        const Turns &turns = TURNS[heading];
+        int choice = 0;
+        while (choice + 1 < turns.count && !s.open(turns.to[choice]))
+            choice++;
+        heading = turns.to[choice];
+        co_yield s.open(heading) ? heading : STAY;
+    }
+}
+
+// Stage 3: serpentine sweeps in eight phases
+StageStrategy stage3(const Senses &s, int &phase) {
+    struct Sweep {
+        int forward; // Run this way until blocked,
+        int back;    // then back until blocked,
+        int step;    // then one step across, until back and step are both walls
+        int next;    // First move of the following phase
+    };
+    static constexpr Sweep SWEEPS[8] = {
+        {},                         // (no phase 0)
+        {UP, DOWN, RIGHT, UP},      // Phase 1: columns, moving right
+        {UP, DOWN, LEFT, UP},       // Phase 2: columns, moving left
+        {UP, DOWN, RIGHT, UP},      // Phase 3: columns, moving right again
+        {},                         // (phase 4 climbs instead)
+        {RIGHT, LEFT, DOWN, RIGHT}, // Phase 5: rows, moving down
+        {RIGHT, LEFT, UP, RIGHT},   // Phase 6: rows, moving up
+        {RIGHT, LEFT, DOWN, UP},    // Phase 7: rows, moving down again
+    };
+
+    for (phase = 1; phase <= 7; phase++) {
+        if (phase == 4) {
+            // Phase 4: up to the top, then on to the row sweeps
+            while (s.open(UP))
+                co_yield UP;
+            co_yield s.open(RIGHT) ? RIGHT : STAY;
+            continue;
+        }
+        const Sweep &sweep = SWEEPS[phase];
+        for (;;) {
+            while (s.open(sweep.forward))
+                co_yield sweep.forward;
+            co_yield s.open(sweep.back) ? sweep.back : STAY;
+            while (s.open(sweep.back))
+                co_yield sweep.back;
+            if (s.wall[sweep.back] && s.wall[sweep.step])
+                break;
+            co_yield s.open(sweep.step) ? sweep.step : STAY;
+        }
+        co_yield s.open(sweep.next) ? sweep.next : STAY;
+    }
+
+    // Phase 8: zigzag right, one step up at every wall
+    for (;;) {
+        co_yield s.open(UP) ? UP : s.open(RIGHT) ? RIGHT : STAY;
+        while (s.open(RIGHT))
+            co_yield RIGHT;
+        co_yield s.open(UP) ? UP : STAY;
+    }
+}
+
+} // namespace
+
+StageStrategy stageScript(int stage, StrategyFrame &frame, const Senses &senses, int &phase) {
+    StrategyFrame::Scope scope(frame);
+    switch (stage) {
+    case 0:
+        return stage0(senses, phase);
+    case 1:
+        return stage1(senses, phase);
+    case 2:
+        return stage2(senses, phase);
+    case 3:
+        return stage3(senses, phase);
+    default:
+        return StageStrategy();
+    }
+}
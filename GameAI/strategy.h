@@ -0,0 +1,119 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Moves, as returned by Brain::getNextMove
+enum Move : int {
+    STAY = 0,
+    UP = 1,
+    LEFT = 2,
+    DOWN = 3,
+    RIGHT = 4
+};
+
+// What a stage script sees around the player this cycle. The Brain refreshes
+// it in place before every resume, so a script holds one reference for its
+// whole life and always reads the current cycle through it.
+struct Senses {
+    char direction{' '}; // Facing of the player
+    bool wall[5]{};      // '+' next to the player, indexed by Move
+    bool passable[5]{};  // Can step there ('A' and 'B' included when allowed), indexed by Move
+    bool wall_up_right{false};
+    int prev_move{0};    // Move played on the previous cycle of this stage (0 on its first)
+
+    bool open(int move) const { return !wall[move] && passable[move]; }
+};
+
+// Inline storage for the frame of one running stage script. A Brain owns one and
+// runs at most one script at a time, so starting a script never allocates and
+// suspending it costs nothing beyond saving its locals in the frame. Coroutine
+// frames are allocated by a plain operator new, so the frame is handed over
+// through a Scope around the call that starts the script.
+struct StrategyFrame {
+    static constexpr size_t CAPACITY = 512;
+    alignas(std::max_align_t) std::byte bytes[CAPACITY];
+
+    static inline thread_local StrategyFrame *scoped = nullptr; // Frame the next script on this thread is placed in
+
+    // Lends a frame to the next script started on this thread while it is alive
+    class Scope {
+        StrategyFrame *previous;
+
+    public:
+        explicit Scope(StrategyFrame &frame) : previous(std::exchange(scoped, &frame)) {}
+        ~Scope() { scoped = previous; }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+};
+
+// Stage script written as sequential code: it co_yields one move per cycle and
+// is resumed on the next cycle with fresh Senses. Scripts run forever, a new
+// stage simply starts a new one.
+class StageStrategy {
+public:
+    struct promise_type {
+        int move{STAY};
+
+        // The frame goes into the StrategyFrame in scope, taken by the first script started
+        static void *operator new(size_t size) {
+            if (size > StrategyFrame::CAPACITY)
+                return ::operator new(size); // Larger than any current script: still works, from the heap
+            StrategyFrame *frame = std::exchange(StrategyFrame::scoped, nullptr);
+            if (frame == nullptr)
+                throw std::runtime_error("Stage script started without a StrategyFrame in scope");
+            return frame->bytes;
+        }
+        static void operator delete(void *frame, size_t size) {
+            if (size > StrategyFrame::CAPACITY)
+                ::operator delete(frame);
+        }
+
+        StageStrategy get_return_object() { return StageStrategy(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; } // The first move is computed by the first resume
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(int next) noexcept {
+            move = next;
+            return {};
+        }
+        void return_void() { move = STAY; }
+        void unhandled_exception() { throw; }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit StageStrategy(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+public:
+    StageStrategy() = default;
+    StageStrategy(StageStrategy &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+    StageStrategy &operator=(StageStrategy &&other) noexcept {
+        reset();
+        handle = std::exchange(other.handle, {});
+        return *this;
+    }
+    ~StageStrategy() { reset(); }
+
+    explicit operator bool() const { return static_cast<bool>(handle); }
+    void reset() { // Destroys the script and frees its frame (before another one may use it)
+        if (handle)
+            std::exchange(handle, {}).destroy();
+    }
+    int next() { // Runs the script up to its next move; STAY once it has finished
+        if (!handle.done())
+            handle.resume();
+        return handle.promise().move;
+    }
+};
+
+// Script of the given stage (0 to 3), empty for stages without one
+StageStrategy stageScript(int stage, StrategyFrame &frame, const Senses &senses, int &phase);
+
+#endif // STRATEGY_H
@@ -0,0 +1,161 @@
+#include "world_model.h"
+#include <algorithm>
+
+using std::vector;
+
+WorldModel::WorldModel() : rows(0), words(0) {
+    reset();
+}
+
+void WorldModel::reset() {
+    // Keep the covered area: all-zero planes read as unknown, and the next episode reuses the storage
+    for (auto &plane : planes) {
+        std::fill(plane.begin(), plane.end(), 0);
+    }
+    left_word = 0;
+    right_word = 0;
+    carrying = false;
+}
+
+void WorldModel::ensure(int h, int w) {
+    // Keep one spare row and column past every known cell so the edge of the known area reads as unknown
+    int need_rows = h + 2;
+    int need_words = (w + 1) / 64 + 1;
+    if (need_rows <= rows && need_words <= words) return;
+    int new_rows = need_rows > rows ? std::max(need_rows, rows * 2) : rows;
+    int new_words = need_words > words ? std::max(need_words, words * 2) : words;
+    for (auto &plane : planes) {
+        vector<uint64_t> larger(static_cast<size_t>(new_rows) * new_words, 0);
+        for (int r = 0; r < rows; r++) {
+            std::copy_n(plane.begin() + static_cast<size_t>(r) * words, words, larger.begin() + static_cast<size_t>(r) * new_words);
+        }
+        plane.swap(larger);
+    }
+    rows = new_rows;
+    words = new_words;
+    passable.assign(planes[KNOWN].size(), 0);
+    reached.assign(planes[KNOWN].size(), 0);
+    grown.assign(planes[KNOWN].size(), 0);
+}
+
+void WorldModel::setCell(Plane plane, int h, int w, bool on) {
+    uint64_t &word = planes[plane][static_cast<size_t>(h) * words + w / 64];
+    uint64_t bit = uint64_t{1} << (w % 64);
+    word = on ? (word | bit) : (word & ~bit);
+}
+
+bool WorldModel::cell(Plane plane, int h, int w) const {
+    if (h < 0 || h >= rows || w < 0 || w / 64 >= words) return false;
+    return (planes[plane][static_cast<size_t>(h) * words + w / 64] >> (w % 64)) & 1;
+}
+
+bool WorldModel::isKnown(int h, int w) const {
+    return cell(KNOWN, h, w);
+}
+
+bool WorldModel::isWall(int h, int w) const {
+    return cell(WALL, h, w);
+}
+
+void WorldModel::enterStage(int w) {
+    left_word = std::max(0, w / 64 - 1); // Earlier stages only matter as far as the last word of context
+    carrying = false;
+}
+
+void WorldModel::merge(const Vision &vision, const std::array<int, 2> &pos) {
+    if (vision.empty()) return;
+    if (cell(FLAG, pos[0], pos[1])) {
+        carrying = true; // Standing where an 'A' was: it has been picked
+    }
+    int top = pos[0] - vision.player_row;
+    int left = pos[1] - vision.player_col;
+    ensure(top + vision.rows - 1, left + vision.cols - 1);
+    for (int i = 0; i < vision.rows; i++) {
+        for (int j = 0; j < vision.cols; j++) {
+            int h = top + i;
+            int w = left + j;
+            char tile = vision[i][j];
+            bool open = (tile == ' ' || tile == '0' || tile == 'A' || tile == 'B' || tile == 'w' ||
+                         tile == '>' || tile == '<' || tile == '^' || tile == 'v');
+            bool hazard = (tile == 'T' || tile == 'X');
+            setCell(KNOWN, h, w, true);
+            setCell(WALL, h, w, !open && !hazard); // Unrecognised tiles count as walls
+            setCell(HAZARD, h, w, hazard);
+            setCell(FOOD, h, w, tile == '0');
+            setCell(FLAG, h, w, tile == 'A');
+            setCell(PLACE, h, w, tile == 'B');
+            setCell(GOAL, h, w, tile == 'w');
+            setCell(DOOR, h, w, tile == 'D');
+        }
+    }
+    right_word = std::max(right_word, std::min(words - 1, (left + vision.cols - 1) / 64));
+}
+
+int WorldModel::nextMove(const std::array<int, 2> &pos) {
+    ensure(pos[0], pos[1]);
+    int move = flood(pos[0], pos[1], ITEMS);
+    if (move == 0) {
+        move = flood(pos[0], pos[1], FRONTIER);
+    }
+    if (move == 0) {
+        move = flood(pos[0], pos[1], DOORS);
+    }
+    return move;
+}
+
+int WorldModel::flood(int h, int w, Target target) {
+    // Grow the target set one step per pass through passable cells until it touches the player;
+    // the neighbour it touches first lies on a shortest path. Only words [lo, hi] take part.
+    int lo = std::min(left_word, words - 1);
+    int hi = std::min(words - 1, right_word + 1);
+    bool any_target = false;
+    for (int r = 0; r < rows; r++) {
+        for (int k = lo; k <= hi; k++) {
+            size_t i = static_cast<size_t>(r) * words + k;
+            uint64_t known = planes[KNOWN][i];
+            uint64_t flags = carrying ? planes[FLAG][i] : planes[PLACE][i]; // The unusable half of the A/B pair blocks
+            passable[i] = known & ~(planes[WALL][i] | planes[HAZARD][i] | flags);
+            if (target == FRONTIER) {
+                reached[i] = ~known;
+            } else if (target == DOORS) {
+                reached[i] = planes[DOOR][i];
+            } else {
+                uint64_t items = planes[FOOD][i] | planes[GOAL][i] | (carrying ? planes[PLACE][i] : planes[FLAG][i]);
+                reached[i] = known & items;
+            }
+            any_target = any_target || reached[i] != 0;
+        }
+    }
+    if (!any_target) return 0;
+
+    struct Step {
+        int dh;
+        int dw;
+        int move;
+    };
+    const Step steps[4] = {{0, 1, 4}, {1, 0, 3}, {-1, 0, 1}, {0, -1, 2}}; // Right first: the goal is always to the right
+    while (true) {
+        for (const Step &step : steps) {
+            int nh = h + step.dh;
+            int nw = w + step.dw;
+            if (nh < 0 || nh >= rows || nw < lo * 64 || nw >= (hi + 1) * 64) continue;
+            if ((reached[static_cast<size_t>(nh) * words + nw / 64] >> (nw % 64)) & 1) return step.move;
+        }
+        uint64_t changed = 0;
+        for (int r = 0; r < rows; r++) {
+            for (int k = lo; k <= hi; k++) {
+                size_t i = static_cast<size_t>(r) * words + k;
+                uint64_t x = reached[i];
+                uint64_t from_left = (k > lo) ? reached[i - 1] >> 63 : 0;
+                uint64_t from_right = (k < hi) ? reached[i + 1] << 63 : 0;
+                uint64_t spread = (x << 1) | from_left | (x >> 1) | from_right;
+                if (r > 0) spread |= reached[i - words];
+                if (r + 1 < rows) spread |= reached[i + words];
+                grown[i] = x | (spread & passable[i]);
+                changed |= grown[i] ^ x;
+            }
+        }
+        if (!changed) return 0; // Targets are cut off from the player
+        reached.swap(grown);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef WORLD_MODEL_H
+#define WORLD_MODEL_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "../Game/game.h"
+
+// Everything the brain has seen so far, kept as packed bit planes (one bit per
+// map cell, rows of 64-bit words). Each vision window is merged in at the
+// player's position, and path queries flood whole words at a time, so both
+// stay cheap on maps with thousands of columns. The planes grow as the player
+// discovers cells further down or to the right.
+class WorldModel {
+public:
+    enum Plane {
+        WALL,    // '+', closed doors and anything else that blocks
+        HAZARD,  // 'T' and the last seen cells of 'X'
+        FOOD,    // '0'
+        FLAG,    // 'A' (walkable until one was picked in this stage)
+        PLACE,   // 'B' (walkable once an 'A' was picked in this stage)
+        GOAL,    // 'w'
+        DOOR,    // 'D' as last seen (also in WALL; it may have opened since)
+        KNOWN,   // Cells that were in vision at least once (unknown = ~KNOWN)
+        PLANE_COUNT
+    };
+
+private:
+    int rows;                                          // Rows covered by the planes
+    int words;                                         // 64-bit words per row
+    std::array<std::vector<uint64_t>, PLANE_COUNT> planes;
+    std::vector<uint64_t> passable;                    // Scratch planes for flood fills
+    std::vector<uint64_t> reached;
+    std::vector<uint64_t> grown;
+    int left_word;    // Floods ignore words left of this one (earlier stages)
+    int right_word;   // Rightmost word holding a known cell
+    bool carrying;    // Walked over an 'A' since the last stage change
+
+    void ensure(int h, int w);                          // Grows the planes to cover (h, w)
+    void setCell(Plane plane, int h, int w, bool on);
+    bool cell(Plane plane, int h, int w) const;
+    enum Target {
+        ITEMS,    // Food, flags and the goal
+        FRONTIER, // Unknown cells
+        DOORS     // Doors seen closed, to check whether they opened
+    };
+    int flood(int h, int w, Target target);             // First move towards the nearest target, 0 if none
+
+public:
+    WorldModel();
+    void reset();                                               // Forgets everything (the planes keep their size)
+    void merge(const Vision &vision, const std::array<int, 2> &pos); // Adds the vision window around pos
+    void enterStage(int w);                                     // Player entered a new stage at column w
+    bool isKnown(int h, int w) const;
+    bool isWall(int h, int w) const;
+    int nextMove(const std::array<int, 2> &pos);                // Items first, then unknown cells, then closed doors
+};
+
+#endif // WORLD_MODEL_H
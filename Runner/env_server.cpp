@@ -0,0 +1,187 @@
+#include "env_server.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using std::string;
+
+static_assert(MAZE_ENV_VISION_DIM == Vision::MAX_DIM, "maze_env.h vision windows must match Vision");
+static_assert(sizeof(maze_env_obs) == 32 && sizeof(maze_env_counter) == 64, "maze_env.h layout changed");
+
+namespace
+{
+    constexpr uint64_t CACHE_LINE = 64;
+
+    uint64_t alignUp(uint64_t bytes)
+    {
+        return (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    }
+}
+
+EnvServer::EnvServer(const EnvServerConfig &settings) : config(settings)
+{
+    if (config.envs == 0 || config.ring_slots == 0 || config.envs > (1u << 20))
+        throw std::runtime_error("Environment server needs 1 to 2^20 games and at least one ring slot");
+    if (config.name.empty() || config.name[0] != '/')
+        throw std::runtime_error("Shared memory name must start with '/': " + config.name);
+
+    auto start = Game::loadTemplate(config.map); // Parsed once, every game copies it and resets from it
+    for (uint32_t i{0}; i < config.envs; i++)
+    {
+        games.push_back(std::make_unique<Game>(start)); // Headless and quiet
+        games.back()->setLazyEnemies(true); // Observations only need the vision box and the counters
+        games.back()->initGame();
+    }
+    states.resize(config.envs);
+    if (config.threads > 1)
+    {
+        pool = std::make_unique<ThreadPool>(config.threads);
+        size_t chunk = (games.size() + pool->size() - 1) / pool->size();
+        for (size_t first{0}; first < games.size(); first += chunk)
+            chunks.push_back({nullptr, first, std::min(games.size(), first + chunk)});
+    }
+
+    // Header, then the slots: actions, vision windows and observation records, each cache line aligned
+    uint64_t actions_bytes = alignUp(config.envs);
+    uint64_t vision_bytes = alignUp(static_cast<uint64_t>(config.envs) * MAZE_ENV_VISION_CELLS);
+    uint64_t obs_bytes = alignUp(static_cast<uint64_t>(config.envs) * sizeof(maze_env_obs));
+    uint64_t slot_bytes = actions_bytes + vision_bytes + obs_bytes;
+    uint64_t slots_offset = alignUp(sizeof(maze_env_header));
+    length = slots_offset + slot_bytes * config.ring_slots;
+
+    ::shm_unlink(config.name.c_str()); // Left over by a server that did not shut down cleanly
+    int fd = ::shm_open(config.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw std::runtime_error("Could not create shared memory object: " + config.name);
+    if (::ftruncate(fd, static_cast<off_t>(length)) != 0)
+    {
+        ::close(fd);
+        ::shm_unlink(config.name.c_str());
+        throw std::runtime_error("Could not size shared memory object: " + config.name);
+    }
+    memory = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps its own reference
+    if (memory == MAP_FAILED)
+    {
+        memory = nullptr;
+        ::shm_unlink(config.name.c_str());
+        throw std::runtime_error("Could not map shared memory object: " + config.name);
+    }
+
+    header = static_cast<maze_env_header *>(memory); // Zero filled by ftruncate
+    header->version = MAZE_ENV_VERSION;
+    header->num_envs = config.envs;
+    header->ring_slots = config.ring_slots;
+    header->vision_dim = MAZE_ENV_VISION_DIM;
+    header->spin_limit = std::thread::hardware_concurrency() > 1 ? 4096 : 0; // Spinning only helps if the peer runs meanwhile
+    header->slots_offset = slots_offset;
+    header->slot_bytes = slot_bytes;
+    header->vision_offset = actions_bytes;
+    header->obs_offset = actions_bytes + vision_bytes;
+    header->total_bytes = length;
+
+    // Batch 0: the observations of the freshly loaded games
+    for (uint32_t i{0}; i < config.envs; i++)
+    {
+        games[i]->getGameState(states[i]);
+        observe(i, slot(0), false, 0, false);
+    }
+    header->request.seq = 1;
+    header->response.seq = 1;
+    __atomic_store_n(&header->magic, MAZE_ENV_MAGIC, __ATOMIC_RELEASE); // Clients may map it from here on
+}
+
+EnvServer::~EnvServer()
+{
+    if (memory)
+    {
+        ::munmap(memory, length);
+        ::shm_unlink(config.name.c_str());
+    }
+}
+
+uint8_t *EnvServer::slot(uint32_t batch) const
+{
+    return static_cast<uint8_t *>(memory) + header->slots_offset + static_cast<uint64_t>(batch % header->ring_slots) * header->slot_bytes;
+}
+
+void EnvServer::observe(size_t env, uint8_t *slot_base, bool done, int final_score, bool won)
+{
+    const GameState &state = states[env];
+    char *vision = reinterpret_cast<char *>(slot_base + header->vision_offset) + env * MAZE_ENV_VISION_CELLS;
+    std::memset(vision, 0, MAZE_ENV_VISION_CELLS); // Cells outside the clipped window read as 0
+    for (size_t r{0}; r < state.vision.size(); r++)
+    {
+        std::memcpy(vision + r * MAZE_ENV_VISION_DIM, state.vision[r].data(), state.vision[r].size());
+    }
+
+    maze_env_obs &obs = reinterpret_cast<maze_env_obs *>(slot_base + header->obs_offset)[env];
+    obs.stage = state.stage;
+    obs.score = state.score;
+    obs.cycle = state.cycle;
+    obs.pos_h = state.pos[0];
+    obs.pos_w = state.pos[1];
+    obs.final_score = final_score;
+    obs.vision_rows = static_cast<uint8_t>(state.vision.rows);
+    obs.vision_cols = static_cast<uint8_t>(state.vision.cols);
+    obs.player_row = static_cast<int8_t>(state.vision.player_row);
+    obs.player_col = static_cast<int8_t>(state.vision.player_col);
+    obs.facing = state.vision.facing;
+    obs.done = done;
+    obs.won = won;
+    obs.reserved = 0;
+}
+
+void EnvServer::stepRange(uint8_t *slot_base, size_t first, size_t last)
+{
+    const int8_t *actions = reinterpret_cast<const int8_t *>(slot_base);
+    for (size_t i = first; i < last; i++)
+    {
+        Game &game = *games[i];
+        int action = actions[i];
+        game.advanceGameCycle(action >= 0 && action <= 4 ? action : 0); // Anything else stays put
+        bool done = game.isGameOver();
+        int final_score = game.getScore();
+        bool won = game.isGameWon();
+        if (done)
+            game.reset(); // Auto-reset: the observation shows the next episode
+        game.getGameState(states[i]);
+        observe(i, slot_base, done, done ? final_score : 0, done && won);
+    }
+}
+
+uint64_t EnvServer::run()
+{
+    uint64_t served{0};
+    for (uint32_t batch = header->response.seq;; batch++) // Clients may have submitted before run() started
+    {
+        maze_env_wait_seq(&header->request, batch + 1, header->spin_limit);
+        if (__atomic_load_n(&header->request.shutdown, __ATOMIC_RELAXED) == batch + 1)
+            return served; // Ordered by the acquire load of request.seq in the wait
+
+        uint8_t *slot_base = slot(batch);
+        if (!pool)
+        {
+            stepRange(slot_base, 0, games.size());
+        }
+        else
+        {
+            for (StepChunk &chunk : chunks)
+            {
+                chunk.slot_base = slot_base;
+                // Two pointers fit std::function's inline buffer, so submitting does not allocate
+                pool->submit([this, task = &chunk]
+                             { stepRange(task->slot_base, task->first, task->last); });
+            }
+            pool->wait();
+        }
+        maze_env_publish_seq(&header->response, batch + 1);
+        served++;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef ENV_SERVER_H
+#define ENV_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Game/game.h"
+#include "maze_env.h"
+#include "thread_pool.h"
+
+struct EnvServerConfig
+{
+    std::string name;       // Shared memory object name, e.g. "/maze_env"
+    std::string map;        // Map every environment plays
+    uint32_t envs{16};      // Games stepped per batch
+    uint32_t ring_slots{4}; // Batches a client can keep in flight
+    size_t threads{1};      // Threads stepping a batch (1 = the serving thread alone)
+};
+
+// Hosts a batch of headless games behind the shared-memory protocol of maze_env.h.
+// A batch is stepped in place: actions are read from the slot and observations are
+// written back into it, so nothing is serialized and the only system calls are
+// futex waits and wakes when one side has gone to sleep.
+class EnvServer
+{
+    EnvServerConfig config;
+    void *memory{nullptr};
+    size_t length{0};
+    maze_env_header *header{nullptr};
+    std::vector<std::unique_ptr<Game>> games;
+    std::vector<GameState> states; // Per game scratch state, reused every step
+    std::unique_ptr<ThreadPool> pool; // Only when stepping on more than one thread
+
+    struct StepChunk
+    {
+        uint8_t *slot_base; // Slot of the batch being stepped
+        size_t first;       // Games [first, last) of this chunk
+        size_t last;
+    };
+    std::vector<StepChunk> chunks; // One per pool worker, refilled every batch: a task only carries a pointer to its chunk
+
+    uint8_t *slot(uint32_t batch) const;
+    void observe(size_t env, uint8_t *slot_base, bool done, int final_score, bool won); // Writes one game's observation
+    void stepRange(uint8_t *slot_base, size_t first, size_t last);                    // Steps games [first, last)
+
+public:
+    explicit EnvServer(const EnvServerConfig &); // Loads the games, creates the shared object and writes batch 0
+    ~EnvServer();                                // Unmaps and unlinks the shared object
+    EnvServer(const EnvServer &) = delete;
+    EnvServer &operator=(const EnvServer &) = delete;
+
+    uint64_t run(); // Serves batches until a client asks for shutdown, returns the batches stepped
+};
+
+#endif // ENV_SERVER_H
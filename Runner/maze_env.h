@@ -0,0 +1,220 @@
+#ifndef MAZE_ENV_H
+#define MAZE_ENV_H
+
+/*
+ * Shared-memory protocol of the batched environment server (run.out -env NAME).
+ * Plain C (gnu11 or C++), Linux only: the two sides wait on futexes in the mapping.
+ *
+ * The shared object holds a maze_env_header followed by ring_slots batch slots of
+ * slot_bytes each. A slot is one contiguous block:
+ *
+ *   int8_t       actions[num_envs]                       written by the client
+ *   char         vision[num_envs][MAZE_ENV_VISION_CELLS] at vision_offset, 7 x 7 windows row-major
+ *   maze_env_obs obs[num_envs]                           at obs_offset
+ *
+ * Batch k uses slot k % ring_slots. Batch 0 is the initial reset, written by the
+ * server before it sets the magic. For every later batch the client fills the
+ * actions and publishes request.seq = k + 1; the server steps every game, writes the
+ * observations into the same slot and publishes response.seq = k + 1. Publishing
+ * only makes a futex call when the other side is asleep.
+ *
+ * A client may keep up to ring_slots batches in flight, but it must be done reading
+ * the observations of batch k before it begins batch k + ring_slots.
+ *
+ * Finished episodes are reset automatically: when obs.done is set, the episode
+ * ended with that step, final_score and won describe it, and every other field
+ * (and the vision window) already belongs to the fresh episode.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define MAZE_ENV_MAGIC 0x564e455au /* "ZENV" */
+#define MAZE_ENV_VERSION 1u
+#define MAZE_ENV_VISION_DIM 7
+#define MAZE_ENV_VISION_CELLS (MAZE_ENV_VISION_DIM * MAZE_ENV_VISION_DIM)
+
+typedef struct maze_env_counter /* One cache line per direction, each written by one side */
+{
+    uint32_t seq;      /* Batches published so far (plus the reset batch) */
+    uint32_t sleepers; /* Waiters blocked on seq; the publisher only wakes when non-zero */
+    uint32_t shutdown; /* Request side only: 1 + the batch that stops the server instead of being stepped */
+    uint8_t reserved[52];
+} maze_env_counter;
+
+typedef struct maze_env_header
+{
+    uint32_t magic;         /* MAZE_ENV_MAGIC once the server has finished setting up */
+    uint32_t version;       /* MAZE_ENV_VERSION */
+    uint32_t num_envs;      /* Games per batch */
+    uint32_t ring_slots;    /* Slots in the ring */
+    uint32_t vision_dim;    /* Side of a vision window (MAZE_ENV_VISION_DIM) */
+    uint32_t spin_limit;    /* Polls before sleeping on a futex (0 on single CPU hosts) */
+    uint64_t slots_offset;  /* Byte offset of slot 0 from the start of the mapping */
+    uint64_t slot_bytes;    /* Size of one slot */
+    uint64_t vision_offset; /* Offset of the vision windows inside a slot */
+    uint64_t obs_offset;    /* Offset of the maze_env_obs array inside a slot */
+    uint64_t total_bytes;   /* Size of the whole mapping */
+    maze_env_counter request;  /* Client -> server */
+    maze_env_counter response; /* Server -> client */
+} maze_env_header;
+
+typedef struct maze_env_obs
+{
+    int32_t stage;       /* Stage of the player */
+    int32_t score;       /* Score so far */
+    int32_t cycle;       /* Cycles played */
+    int32_t pos_h;       /* Player row */
+    int32_t pos_w;       /* Player column */
+    int32_t final_score; /* Score the finished episode ended with (when done) */
+    uint8_t vision_rows; /* Window size after clipping to the map; other cells are 0 */
+    uint8_t vision_cols;
+    int8_t player_row;   /* Player offset inside the window */
+    int8_t player_col;
+    char facing;         /* Direction the player is facing */
+    uint8_t done;        /* The episode ended with this step and was reset */
+    uint8_t won;         /* The finished episode reached the goal (when done) */
+    uint8_t reserved;
+} maze_env_obs;
+
+/* Wait and publish primitives, shared by the server and the clients */
+
+static inline int maze_env_reached(uint32_t seq, uint32_t target)
+{
+    return (int32_t)(seq - target) >= 0; /* Wraparound safe */
+}
+
+static inline void maze_env_wait_seq(maze_env_counter *counter, uint32_t target, uint32_t spin_limit)
+{
+    for (uint32_t spin = 0; spin < spin_limit; spin++)
+    {
+        if (maze_env_reached(__atomic_load_n(&counter->seq, __ATOMIC_ACQUIRE), target))
+            return;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    for (;;)
+    {
+        __atomic_add_fetch(&counter->sleepers, 1, __ATOMIC_SEQ_CST);
+        uint32_t seen = __atomic_load_n(&counter->seq, __ATOMIC_SEQ_CST); /* Pairs with the publisher's check of sleepers */
+        if (!maze_env_reached(seen, target))
+            syscall(SYS_futex, &counter->seq, FUTEX_WAIT, seen, NULL, NULL, 0);
+        __atomic_sub_fetch(&counter->sleepers, 1, __ATOMIC_SEQ_CST);
+        if (maze_env_reached(__atomic_load_n(&counter->seq, __ATOMIC_ACQUIRE), target))
+            return;
+    }
+}
+
+static inline void maze_env_publish_seq(maze_env_counter *counter, uint32_t seq)
+{
+    __atomic_store_n(&counter->seq, seq, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&counter->sleepers, __ATOMIC_SEQ_CST))
+        syscall(SYS_futex, &counter->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/* Client side */
+
+typedef struct maze_env
+{
+    maze_env_header *header;
+    size_t length;
+    uint32_t next; /* Batch the next maze_env_begin fills */
+} maze_env;
+
+static inline uint8_t *maze_env_slot(const maze_env *env, uint32_t batch)
+{
+    return (uint8_t *)env->header + env->header->slots_offset + (uint64_t)(batch % env->header->ring_slots) * env->header->slot_bytes;
+}
+
+/* Maps the server's shared object. Returns 0, or -1 with errno set (EAGAIN: the server is still starting up) */
+static inline int maze_env_open(maze_env *env, const char *name)
+{
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return -1;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(maze_env_header))
+    {
+        close(fd);
+        errno = EAGAIN; /* Not sized yet */
+        return -1;
+    }
+    void *memory = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+        return -1;
+    maze_env_header *header = (maze_env_header *)memory;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != MAZE_ENV_MAGIC || header->version != MAZE_ENV_VERSION ||
+        header->total_bytes != (uint64_t)info.st_size)
+    {
+        int ready = header->magic == MAZE_ENV_MAGIC;
+        munmap(memory, (size_t)info.st_size);
+        errno = ready ? EPROTO : EAGAIN;
+        return -1;
+    }
+    env->header = header;
+    env->length = (size_t)info.st_size;
+    env->next = __atomic_load_n(&header->request.seq, __ATOMIC_ACQUIRE);
+    return 0;
+}
+
+static inline void maze_env_close(maze_env *env)
+{
+    munmap(env->header, env->length);
+    env->header = NULL;
+}
+
+static inline int8_t *maze_env_actions(const maze_env *env, uint32_t batch)
+{
+    return (int8_t *)maze_env_slot(env, batch);
+}
+
+static inline const char *maze_env_vision(const maze_env *env, uint32_t batch, uint32_t i)
+{
+    return (const char *)maze_env_slot(env, batch) + env->header->vision_offset + (size_t)i * MAZE_ENV_VISION_CELLS;
+}
+
+static inline const maze_env_obs *maze_env_observations(const maze_env *env, uint32_t batch)
+{
+    return (const maze_env_obs *)(maze_env_slot(env, batch) + env->header->obs_offset);
+}
+
+/* Waits until the slot of the next batch is free and returns its action array (0 stay, 1 up, 2 left, 3 down, 4 right) */
+static inline int8_t *maze_env_begin(maze_env *env)
+{
+    maze_env_wait_seq(&env->header->response, env->next - env->header->ring_slots + 1, env->header->spin_limit);
+    return maze_env_actions(env, env->next);
+}
+
+/* Hands the actions filled since maze_env_begin to the server, returns the batch number */
+static inline uint32_t maze_env_submit(maze_env *env)
+{
+    uint32_t batch = env->next++;
+    maze_env_publish_seq(&env->header->request, env->next);
+    return batch;
+}
+
+/* Waits until the observations of a submitted batch are in its slot */
+static inline void maze_env_wait(const maze_env *env, uint32_t batch)
+{
+    maze_env_wait_seq(&env->header->response, batch + 1, env->header->spin_limit);
+}
+
+/* Stops the server once it has served every batch submitted before */
+static inline void maze_env_shutdown(maze_env *env)
+{
+    uint32_t batch = env->next++;
+    __atomic_store_n(&env->header->request.shutdown, batch + 1, __ATOMIC_RELAXED); /* Published by the seq store */
+    maze_env_publish_seq(&env->header->request, env->next);
+}
+
+#endif /* MAZE_ENV_H */
@@ -0,0 +1,164 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+using std::function;
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
+
+namespace
+{
+    thread_local ThreadPool *current_pool = nullptr; // Pool owning the calling thread (if any)
+    thread_local size_t current_index = 0;           // Worker index of the calling thread
+}
+
+void ThreadPool::WorkQueue::pushBack(function<void()> &&task)
+{
+    if (count == ring.size())
+    {
+        std::vector<function<void()>> grown(std::max<size_t>(8, ring.size() * 2));
+        for (size_t i{0}; i < count; i++)
+        {
+            grown[i] = std::move(ring[(head + i) % ring.size()]);
+        }
+        ring.swap(grown);
+        head = 0;
+    }
+    ring[(head + count) % ring.size()] = std::move(task);
+    count++;
+}
+
+function<void()> ThreadPool::WorkQueue::popBack()
+{
+    count--;
+    return std::exchange(ring[(head + count) % ring.size()], nullptr); // Drops the slot's captures right away
+}
+
+function<void()> ThreadPool::WorkQueue::popFront()
+{
+    function<void()> task = std::exchange(ring[head], nullptr);
+    head = (head + 1) % ring.size();
+    count--;
+    return task;
+}
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = 1;
+    for (size_t i{0}; i < thread_count; i++)
+    {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i{0}; i < thread_count; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        unique_lock<mutex> lock(idle_mutex);
+        all_done.wait(lock, [this]
+                      { return pending == 0; }); // Drain without re-throwing task errors
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    // Tasks spawned from a worker stay local (LIFO, cache friendly); others are spread round-robin
+    size_t index = (current_pool == this) ? current_index : next_queue++ % queues.size();
+    pending++;
+    {
+        lock_guard<mutex> lock(queues[index]->mutex);
+        queues[index]->pushBack(std::move(task));
+        queued++;
+    }
+    {
+        lock_guard<mutex> lock(idle_mutex); // Pairs with the predicate check in workerLoop
+    }
+    work_ready.notify_one();
+}
+
+bool ThreadPool::popTask(size_t index, function<void()> &task)
+{
+    {
+        WorkQueue &own = *queues[index];
+        lock_guard<mutex> lock(own.mutex);
+        if (!own.empty())
+        {
+            task = own.popBack();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t offset{1}; offset < queues.size(); offset++)
+    {
+        WorkQueue &victim = *queues[(index + offset) % queues.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.empty())
+        {
+            task = victim.popFront(); // Steal the oldest task
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    current_pool = this;
+    current_index = index;
+    function<void()> task;
+    while (true)
+    {
+        if (popTask(index, task))
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(idle_mutex);
+                if (!first_error)
+                    first_error = std::current_exception(); // Re-thrown by wait()
+            }
+            task = nullptr;
+            if (--pending == 0)
+            {
+                lock_guard<mutex> lock(idle_mutex);
+                all_done.notify_all();
+            }
+            continue;
+        }
+        unique_lock<mutex> lock(idle_mutex);
+        work_ready.wait(lock, [this]
+                        { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
+
+void ThreadPool::wait()
+{
+    unique_lock<mutex> lock(idle_mutex);
+    all_done.wait(lock, [this]
+                  { return pending == 0; });
+    if (first_error)
+    {
+        std::exception_ptr error = first_error;
+        first_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a task deque: it pops new work
+// from the back of its own deque and, when that runs dry, steals from the front
+// of the other workers' deques.
+class ThreadPool
+{
+    // Double-ended task queue on a ring that only ever grows: a deque would free and
+    // allocate blocks as steals walk its front forward, even at a steady load.
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::vector<std::function<void()>> ring; // Capacity is ring.size()
+        size_t head{0};                          // Slot of the oldest task
+        size_t count{0};                         // Tasks queued
+
+        bool empty() const { return count == 0; }
+        void pushBack(std::function<void()> &&task);
+        std::function<void()> popBack();  // Newest task (the owner's end)
+        std::function<void()> popFront(); // Oldest task (the thieves' end)
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues; // One deque per worker
+    std::vector<std::thread> workers;
+    std::mutex idle_mutex;              // Guards the sleep/wake protocol below
+    std::condition_variable work_ready; // Signalled when a task is submitted or on shutdown
+    std::condition_variable all_done;   // Signalled when the pending count drops to zero
+    std::atomic<size_t> pending{0};     // Submitted but not yet finished tasks
+    std::atomic<size_t> queued{0};      // Tasks sitting in a deque, not yet claimed by a worker
+    std::atomic<size_t> next_queue{0};  // Round-robin cursor for external submissions
+    std::exception_ptr first_error;     // First exception thrown by a task (guarded by idle_mutex)
+    bool stopping{false};
+
+private:
+    void workerLoop(size_t index);               // Main loop of worker `index`
+    bool popTask(size_t index, std::function<void()> &task); // Own deque first, then steal
+
+public:
+    explicit ThreadPool(size_t thread_count); // Starts thread_count workers (at least one)
+    ~ThreadPool();                            // Waits for queued tasks and joins the workers
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> task); // Queues a task on the calling worker or round-robin
+    void wait();                             // Blocks until every submitted task has finished
+    size_t size() const { return workers.size(); }
+};
+
+#endif // THREAD_POOL_H
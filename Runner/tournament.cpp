@@ -0,0 +1,147 @@
+#include "tournament.h"
+#include "thread_pool.h"
+#include "../Game/game.h"
+#include "../GameAI/brain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+
+using std::endl;
+using std::ostream;
+using std::string;
+using std::vector;
+
+EpisodeResult runEpisode(const string &path_to_map)
+{
+    Game game(path_to_map, 0, true); // Headless and quiet: no banners, no display
+    Brain brain;                     // Fresh brain per episode (all of its state is per instance)
+    game.setLazyEnemies(true);       // Only the score is read back, so far away enemies can lag behind
+    game.initGame();
+    return runEpisode(game, brain);
+}
+
+EpisodeResult runEpisode(Game &game, Brain &brain)
+{
+    GameState game_state;
+    while (!game.isGameOver())
+    {
+        game.getGameState(game_state);
+        game.advanceGameCycle(brain.getNextMove(game_state));
+    }
+
+    EpisodeResult result;
+    result.score = game.getScore();
+    result.cycles = game.getCycle();
+    result.won = game.isGameWon();
+    return result;
+}
+
+vector<MapSummary> runTournament(const TournamentConfig &config, double &elapsed_seconds)
+{
+    for (const auto &path : config.maps)
+    {
+        if (!std::ifstream(path).is_open())
+        {
+            throw std::runtime_error("Could not open map file: " + path); // Fail before spawning any work
+        }
+    }
+
+    size_t episodes = static_cast<size_t>(std::max(config.episodes_per_map, 0));
+    size_t maps = config.maps.size();
+    vector<EpisodeResult> results(maps * episodes); // One slot per episode, no locking needed
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        // Every map is parsed once; games copy the templates and reset from them between episodes
+        vector<std::shared_ptr<const GameTemplate>> templates;
+        for (const auto &path : config.maps)
+            templates.push_back(Game::loadTemplate(path));
+
+        size_t threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+        size_t total = maps * episodes;
+        size_t chunks = std::min(total, threads * 4); // A few chunks per worker keep the load balanced
+        ThreadPool pool(threads);
+        for (size_t c{0}; c < chunks; c++)
+        {
+            size_t first = total * c / chunks;
+            size_t last = total * (c + 1) / chunks;
+            pool.submit([&, first, last]
+                        {
+                            // Run k plays map k % maps in a campaign, otherwise the maps take turns in blocks
+                            vector<std::unique_ptr<Game>> games(maps);
+                            Brain brain;
+                            for (size_t k = first; k < last; k++)
+                            {
+                                size_t m = config.campaign ? k % maps : k / episodes;
+                                size_t e = config.campaign ? k / maps : k % episodes;
+                                if (!games[m])
+                                {
+                                    games[m] = std::make_unique<Game>(templates[m]);
+                                    games[m]->setLazyEnemies(true); // Only the score is read back
+                                    games[m]->initGame();
+                                }
+                                else
+                                {
+                                    games[m]->reset();
+                                }
+                                brain.reset();
+                                results[m * episodes + e] = runEpisode(*games[m], brain);
+                            } });
+        }
+        pool.wait();
+    }
+    elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    vector<MapSummary> summaries;
+    for (size_t m{0}; m < config.maps.size(); m++)
+    {
+        MapSummary summary;
+        summary.map = config.maps[m];
+        for (size_t e{0}; e < episodes; e++)
+        {
+            const EpisodeResult &result = results[m * episodes + e];
+            if (summary.episodes == 0 || result.score < summary.min_score)
+                summary.min_score = result.score;
+            if (summary.episodes == 0 || result.score > summary.max_score)
+                summary.max_score = result.score;
+            summary.episodes++;
+            summary.wins += result.won ? 1 : 0;
+            summary.total_score += result.score;
+            summary.total_cycles += result.cycles;
+        }
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+void printTournamentSummary(ostream &out, const vector<MapSummary> &summaries, double elapsed_seconds)
+{
+    long long total_episodes{0};
+    size_t name_width = 24;
+    for (const auto &summary : summaries)
+        name_width = std::max(name_width, summary.map.size() + 2); // Keep long corpus paths aligned
+    out << std::left << std::setw(name_width) << "map" << std::right
+        << std::setw(10) << "episodes" << std::setw(10) << "win%"
+        << std::setw(12) << "mean score" << std::setw(8) << "min" << std::setw(8) << "max"
+        << std::setw(13) << "mean cycles" << endl;
+    for (const auto &summary : summaries)
+    {
+        double n = summary.episodes ? summary.episodes : 1;
+        out << std::left << std::setw(name_width) << summary.map << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << summary.episodes
+            << std::setw(10) << 100.0 * summary.wins / n
+            << std::setw(12) << summary.total_score / n
+            << std::setw(8) << summary.min_score << std::setw(8) << summary.max_score
+            << std::setw(13) << summary.total_cycles / n << endl;
+        total_episodes += summary.episodes;
+    }
+    out << total_episodes << " episodes in " << std::setprecision(3) << elapsed_seconds << " s";
+    if (elapsed_seconds > 0)
+        out << " (" << std::setprecision(1) << total_episodes / elapsed_seconds << " episodes/s)";
+    out << endl;
+}
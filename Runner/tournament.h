@@ -0,0 +1,43 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct TournamentConfig
+{
+    std::vector<std::string> maps; // Maps to evaluate (every map gets the same number of episodes)
+    int episodes_per_map{100};     // Episodes played on each map
+    size_t threads{0};             // Worker threads (0 = hardware concurrency)
+    bool campaign{false};          // Cycle consecutive episodes across the maps instead of one map after another
+};
+
+struct EpisodeResult
+{
+    int score{0};     // Final score
+    int cycles{0};    // Cycles played until game over
+    bool won{false};  // Whether the goal 'w' was reached
+};
+
+struct MapSummary
+{
+    std::string map;          // Path of the map
+    int episodes{0};          // Episodes played
+    int wins{0};              // Episodes that reached the goal
+    long long total_score{0}; // Sum of final scores
+    long long total_cycles{0}; // Sum of cycles played
+    int min_score{0};         // Lowest final score
+    int max_score{0};         // Highest final score
+};
+
+class Game;
+class Brain;
+
+EpisodeResult runEpisode(const std::string &path_to_map); // Plays one headless Game/Brain episode
+EpisodeResult runEpisode(Game &game, Brain &brain);        // Plays a started game to the end
+std::vector<MapSummary> runTournament(const TournamentConfig &config, double &elapsed_seconds);
+void printTournamentSummary(std::ostream &out, const std::vector<MapSummary> &summaries, double elapsed_seconds);
+
+#endif // TOURNAMENT_H
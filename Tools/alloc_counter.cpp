@@ -0,0 +1,59 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local AllocationCount counts; // Trivial type: no guard, safe to touch from operator new
+
+    void *allocate(std::size_t size)
+    {
+        counts.allocations++;
+        counts.bytes += size;
+        if (void *memory = std::malloc(size ? size : 1))
+            return memory;
+        throw std::bad_alloc();
+    }
+
+    void *allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        counts.allocations++;
+        counts.bytes += size;
+        std::size_t align = static_cast<std::size_t>(alignment);
+        if (void *memory = std::aligned_alloc(align, (size + align - 1) / align * align))
+            return memory;
+        throw std::bad_alloc();
+    }
+}
+
+AllocationCount allocationCount()
+{
+    return counts;
+}
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
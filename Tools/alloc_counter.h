@@ -0,0 +1,32 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts every allocation made through the global operator new. Linking
+// alloc_counter.cpp into a program replaces the global allocation functions;
+// the counters are per thread, so a measurement only sees the calling thread.
+struct AllocationCount
+{
+    uint64_t allocations{0}; // Calls to operator new (any form)
+    uint64_t bytes{0};       // Bytes requested by those calls
+};
+
+AllocationCount allocationCount(); // Totals of the calling thread so far
+
+// Allocations made by the calling thread between construction and stop()
+class AllocationScope
+{
+    AllocationCount start;
+
+public:
+    AllocationScope() : start(allocationCount()) {}
+    AllocationCount stop() const
+    {
+        AllocationCount now = allocationCount();
+        return {now.allocations - start.allocations, now.bytes - start.bytes};
+    }
+};
+
+#endif // ALLOC_COUNTER_H
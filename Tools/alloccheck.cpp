@@ -0,0 +1,188 @@
+// Allocation check: plays one episode per map with every brain strategy, with
+// eager and with lazy enemies, and reports the heap allocations per cycle of
+// Game and Brain. Then it resets both and checks two things, failing if either
+// allocates at all:
+//   repeat   the same episode again: a repeated episode allocates nothing
+//   detours  episodes where random moves override a quarter of the brain's,
+//            so the brain plans from states and cells it never saw
+//
+// What this does not cover: the world model grows its planes the first time the
+// player sees further than in any earlier episode, and the brain's own episode
+// is the one that gets furthest, so the detours stay inside storage the warm-up
+// already sized. Growth on a first visit to a new area still allocates.
+//
+// Usage: alloccheck.out [maps...]   (default: shipped maps and the generated corpus)
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Game/game.h"
+#include "../GameAI/brain.h"
+#include "alloc_counter.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace
+{
+    constexpr uint64_t DETOURS = 8; // Episodes with random detours played after the repeat (seeds 1 to 8)
+
+    struct EpisodeAllocations
+    {
+        AllocationCount game;  // getGameState and advanceGameCycle
+        AllocationCount brain; // getNextMove
+        int cycles{0};
+        int first_cycle{-1};   // First cycle that allocated (-1 if none)
+        int score{0};
+    };
+
+    void add(AllocationCount &total, const AllocationCount &more)
+    {
+        total.allocations += more.allocations;
+        total.bytes += more.bytes;
+    }
+
+    // Overrides a share of the brain's moves with random ones, so an episode leaves the brain's usual path
+    class Detour
+    {
+        uint64_t state;
+
+    public:
+        explicit Detour(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+        int next(int action)
+        {
+            state ^= state << 13; // xorshift64
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state % 4 == 0 ? static_cast<int>((state >> 8) % 5) : action;
+        }
+    };
+
+    EpisodeAllocations playEpisode(Game &game, Brain &brain, GameState &state, uint64_t detour_seed = 0)
+    {
+        EpisodeAllocations result;
+        Detour detour(detour_seed);
+        while (!game.isGameOver())
+        {
+            AllocationScope observe;
+            game.getGameState(state);
+            AllocationCount game_cycle = observe.stop();
+            AllocationScope think;
+            int action = brain.getNextMove(state);
+            AllocationCount brain_cycle = think.stop();
+            if (detour_seed)
+                action = detour.next(action);
+            AllocationScope act;
+            game.advanceGameCycle(action);
+            add(game_cycle, act.stop());
+
+            if (result.first_cycle < 0 && game_cycle.allocations + brain_cycle.allocations > 0)
+                result.first_cycle = result.cycles;
+            add(result.game, game_cycle);
+            add(result.brain, brain_cycle);
+            result.cycles++;
+        }
+        result.score = game.getScore();
+        return result;
+    }
+
+    vector<string> defaultMaps()
+    {
+        vector<string> maps = {"Maps/L1.map", "Maps/L2.map", "Maps/L3.map"};
+        std::error_code error;
+        vector<string> generated;
+        for (const auto &entry : std::filesystem::directory_iterator("Maps/generated", error))
+        {
+            if (entry.path().extension() == ".map")
+                generated.push_back(entry.path().string());
+        }
+        std::sort(generated.begin(), generated.end());
+        maps.insert(maps.end(), generated.begin(), generated.end());
+        return maps;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    vector<string> maps(argv + 1, argv + argc);
+    if (maps.empty())
+        maps = defaultMaps();
+
+    int failures{0};
+    cout << std::left << std::setw(36) << "map" << std::setw(10) << "brain" << std::setw(9) << "enemies" << std::right
+         << std::setw(14) << "game allocs" << std::setw(12) << "game bytes" << std::setw(14) << "brain allocs"
+         << std::setw(13) << "brain bytes" << std::setw(10) << "repeat" << std::setw(10) << "detours" << endl;
+    for (const string &path : maps)
+    {
+        for (BrainStrategy strategy : {BrainStrategy::WorldModel, BrainStrategy::StageScripts})
+        {
+            for (bool lazy : {false, true})
+            {
+                Game game(path, 0, true);
+                game.setLazyEnemies(lazy);
+                game.initGame();
+                Brain brain(strategy);
+                GameState state;
+
+                // Warm-up episode, reported per cycle
+                EpisodeAllocations warm = playEpisode(game, brain, state);
+
+                // The same episode again on the reset game and brain
+                AllocationScope reset;
+                game.reset();
+                brain.reset();
+                AllocationCount reset_count = reset.stop();
+                EpisodeAllocations steady = playEpisode(game, brain, state);
+                uint64_t steady_allocations = reset_count.allocations + steady.game.allocations + steady.brain.allocations;
+
+                // Other paths through the area the warm-up covered
+                uint64_t detour_allocations{0};
+                for (uint64_t seed{1}; seed <= DETOURS; seed++)
+                {
+                    AllocationScope again;
+                    game.reset();
+                    brain.reset();
+                    detour_allocations += again.stop().allocations;
+                    EpisodeAllocations other = playEpisode(game, brain, state, seed);
+                    detour_allocations += other.game.allocations + other.brain.allocations;
+                }
+                double cycles = warm.cycles ? warm.cycles : 1;
+                cout << std::left << std::setw(36) << path << std::setw(10)
+                     << (strategy == BrainStrategy::WorldModel ? "model" : "scripts") << std::setw(9)
+                     << (lazy ? "lazy" : "eager") << std::right << std::fixed << std::setprecision(3)
+                     << std::setw(14) << warm.game.allocations / cycles << std::setw(12) << std::setprecision(1)
+                     << warm.game.bytes / cycles << std::setw(14) << std::setprecision(3) << warm.brain.allocations / cycles
+                     << std::setw(13) << std::setprecision(1) << warm.brain.bytes / cycles << std::setw(10)
+                     << steady_allocations << std::setw(10) << detour_allocations << endl;
+                if (steady_allocations > 0 || steady.score != warm.score)
+                {
+                    failures++;
+                    std::cerr << "  repeated episode allocated: reset " << reset_count.allocations << ", game "
+                              << steady.game.allocations << ", brain " << steady.brain.allocations
+                              << ", first in cycle " << steady.first_cycle;
+                    if (steady.score != warm.score)
+                        std::cerr << " (replay diverged: score " << steady.score << " vs " << warm.score << ")";
+                    std::cerr << endl;
+                }
+                if (detour_allocations > 0)
+                {
+                    failures++;
+                    std::cerr << "  episodes with detours allocated " << detour_allocations << " times" << endl;
+                }
+            }
+        }
+    }
+    if (failures)
+    {
+        std::cerr << failures << " checks allocated after the warm-up" << endl;
+        return 1;
+    }
+    cout << "A repeated episode allocates nothing, nor do episodes with detours" << endl;
+    return 0;
+}
@@ -0,0 +1,274 @@
+// Benchmark suite: nanoseconds per call of the steps of a cycle and whole
+// episodes per second, on the shipped maps and the generated corpus, compared
+// against a stored baseline.
+//
+// Usage: bench.out [-baseline file] [-save file] [-time seconds] [maps...]
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "../Game/game.h"
+#include "../GameAI/brain.h"
+#include "../Runner/tournament.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// Reaches the private steps of Game (declared a friend in game.h)
+struct GameBench
+{
+    static void loadMap(Game &game, const string &path) { game.loadMap(path); }
+    static void getVision(const Game &game, Vision &vision) { game.getVision(vision); }
+    static void checkEnemies(Game &game) { game.checkEnemies(); }
+    static void fillFrame(const Game &game, Frame &frame) { game.fillFrame(frame, true, 21, 80); } // 80x24 terminal
+};
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Result
+    {
+        string map;
+        string operation;
+        double ns; // Per call (per episode for "episode")
+    };
+
+    double elapsedNs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    // Runs batch (which returns the nanoseconds it spent on `calls` calls) until the time
+    // budget is used up; the fastest batch is the least disturbed one and is reported.
+    template <class Batch>
+    double measure(double budget_seconds, long calls, Batch &&batch)
+    {
+        double best = std::numeric_limits<double>::infinity();
+        auto start = Clock::now();
+        int runs{0};
+        while (runs < 3 || elapsedNs(start) < budget_seconds * 1e9)
+        {
+            best = std::min(best, batch() / calls);
+            runs++;
+        }
+        return best;
+    }
+
+    // Plays one Brain episode and keeps its states and actions for replaying
+    void recordEpisode(const string &path, vector<GameState> &states, vector<int> &actions)
+    {
+        Game game(path, 0, true);
+        game.initGame();
+        Brain brain;
+        GameState state;
+        while (!game.isGameOver())
+        {
+            game.getGameState(state);
+            states.push_back(state);
+            actions.push_back(brain.getNextMove(state));
+            game.advanceGameCycle(actions.back());
+        }
+    }
+
+    vector<Result> benchMap(const string &path, double budget)
+    {
+        vector<Result> results;
+        vector<GameState> states;
+        vector<int> actions;
+        recordEpisode(path, states, actions);
+        volatile long sink{0}; // Keeps results of the timed calls alive
+
+        results.push_back({path, "loadMap", measure(budget, 1, [&]
+                                                    {
+                                                        Game game(path, 0, true);
+                                                        auto start = Clock::now();
+                                                        GameBench::loadMap(game, path);
+                                                        return elapsedNs(start); })});
+
+        Game game(path, 0, true);
+        game.initGame();
+        results.push_back({path, "getVision", measure(budget, 1000, [&]
+                                                      {
+                                                          Vision vision;
+                                                          auto start = Clock::now();
+                                                          for (int i{0}; i < 1000; i++)
+                                                          {
+                                                              GameBench::getVision(game, vision);
+                                                              sink = sink + vision.rows;
+                                                          }
+                                                          return elapsedNs(start); })});
+
+        results.push_back({path, "checkEnemies", measure(budget, 1000, [&]
+                                                         {
+                                                             auto start = Clock::now();
+                                                             for (int i{0}; i < 1000; i++)
+                                                             {
+                                                                 GameBench::checkEnemies(game);
+                                                             }
+                                                             return elapsedNs(start); })});
+
+        results.push_back({path, "advanceGameCycle", measure(budget, actions.size(), [&]
+                                                             {
+                                                                 Game episode(path, 0, true);
+                                                                 episode.initGame();
+                                                                 auto start = Clock::now();
+                                                                 for (int action : actions)
+                                                                 {
+                                                                     episode.advanceGameCycle(action);
+                                                                 }
+                                                                 return elapsedNs(start); })});
+
+        // Diff rendering of a whole episode into /dev/null through the same renderer the visual modes use
+        int null_fd = open("/dev/null", O_WRONLY);
+        results.push_back({path, "displayGame", measure(budget, actions.size(), [&]
+                                                        {
+                                                            Game episode(path, 0, true);
+                                                            episode.initGame();
+                                                            TerminalRenderer renderer(null_fd);
+                                                            Frame frame;
+                                                            double ns{0};
+                                                            for (int action : actions)
+                                                            {
+                                                                auto start = Clock::now();
+                                                                GameBench::fillFrame(episode, frame);
+                                                                renderer.draw(frame);
+                                                                ns += elapsedNs(start);
+                                                                episode.advanceGameCycle(action);
+                                                            }
+                                                            return ns; })});
+        close(null_fd);
+
+        results.push_back({path, "getNextMove", measure(budget, states.size(), [&]
+                                                        {
+                                                            Brain brain; // Same state sequence, so the same decisions
+                                                            auto start = Clock::now();
+                                                            for (GameState &state : states)
+                                                            {
+                                                                sink = sink + brain.getNextMove(state);
+                                                            }
+                                                            return elapsedNs(start); })});
+
+        results.push_back({path, "episode", measure(budget, 1, [&]
+                                                    {
+                                                        auto start = Clock::now();
+                                                        sink = sink + runEpisode(path).score;
+                                                        return elapsedNs(start); })});
+        return results;
+    }
+
+    std::map<std::pair<string, string>, double> readBaseline(const string &path)
+    {
+        std::map<std::pair<string, string>, double> baseline;
+        std::ifstream in(path);
+        string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream fields(line);
+            string map, operation;
+            double ns;
+            if (fields >> map >> operation >> ns)
+                baseline[{map, operation}] = ns;
+        }
+        return baseline;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    string baseline_path;
+    string save_path;
+    double budget{0.2}; // Seconds spent on each measurement
+    vector<string> maps;
+    for (int i{1}; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "-baseline" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (arg == "-save" && i + 1 < argc)
+            save_path = argv[++i];
+        else if (arg == "-time" && i + 1 < argc)
+            budget = std::stod(argv[++i]);
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            cerr << "Usage: " << argv[0] << " [-baseline file] [-save file] [-time seconds] [maps...]" << endl;
+            return 1;
+        }
+        else
+            maps.push_back(arg);
+    }
+    if (maps.empty())
+    {
+        maps = {"Maps/L1.map", "Maps/L2.map", "Maps/L3.map", "Maps/generated/medium_500x20.map",
+                "Maps/generated/large_5000x40.map", "Maps/generated/huge_20000x64.map",
+                "Maps/generated/crowded_2000x48.map"};
+    }
+
+    auto baseline = readBaseline(baseline_path);
+    vector<Result> all;
+    cout << std::left << std::setw(36) << "map" << std::setw(18) << "operation" << std::right << std::setw(14) << "ns/op"
+         << std::setw(14) << "baseline" << std::setw(10) << "change" << endl;
+    try
+    {
+        for (const string &map : maps)
+        {
+            if (!std::ifstream(map).is_open())
+            {
+                cerr << "Skipping " << map << " (not found; `make corpus` generates the synthetic maps)" << endl;
+                continue;
+            }
+            for (const Result &result : benchMap(map, budget))
+            {
+                cout << std::left << std::setw(36) << result.map << std::setw(18) << result.operation << std::right
+                     << std::fixed << std::setprecision(1) << std::setw(14) << result.ns;
+                auto found = baseline.find({result.map, result.operation});
+                if (found != baseline.end())
+                {
+                    double change = (result.ns / found->second - 1.0) * 100.0;
+                    cout << std::setw(14) << found->second << std::setw(9) << std::showpos << change << "%" << std::noshowpos;
+                }
+                if (result.operation == "episode")
+                    cout << "   (" << std::setprecision(1) << 1e9 / result.ns << " episodes/s)";
+                cout << endl;
+                all.push_back(result);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    if (!save_path.empty())
+    {
+        std::ofstream out(save_path);
+        out << "# map operation ns_per_op (written by bench.out -save)" << endl;
+        for (const Result &result : all)
+        {
+            out << result.map << ' ' << result.operation << ' ' << std::fixed << std::setprecision(1) << result.ns << endl;
+        }
+        if (!out)
+        {
+            cerr << "Error: could not write " << save_path << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Example client of the shared-memory environment server, in plain C: plays
+// random moves on every game, checks the observations it gets back and reports
+// the step rate. Start the server first (run.out -env NAME [-envs N] [-map M]).
+//
+// Usage: env_client.out NAME [batches] [in_flight]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../Runner/maze_env.h"
+
+static uint64_t next_random(uint64_t *state) // xorshift64
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s NAME [batches] [in_flight]\n", argv[0]);
+        return 1;
+    }
+    long batches = argc > 2 ? atol(argv[2]) : 10000;
+    long in_flight = argc > 3 ? atol(argv[3]) : 1;
+
+    maze_env env;
+    int attempts = 0;
+    while (maze_env_open(&env, argv[1]) != 0)
+    {
+        if ((errno != ENOENT && errno != EAGAIN) || ++attempts > 100)
+        {
+            perror("maze_env_open");
+            return 1;
+        }
+        struct timespec pause = {0, 50 * 1000 * 1000};
+        nanosleep(&pause, NULL); // Server still loading its games
+    }
+    uint32_t envs = env.header->num_envs;
+    if (in_flight < 1 || in_flight > (long)env.header->ring_slots)
+        in_flight = env.header->ring_slots;
+
+    // The previous observations of every game, to check each step against
+    maze_env_obs *last = malloc(sizeof(maze_env_obs) * envs);
+    uint32_t first = env.next - 1;
+    maze_env_wait(&env, first);
+    memcpy(last, maze_env_observations(&env, first), sizeof(maze_env_obs) * envs);
+
+    uint64_t random = 0x9E3779B97F4A7C15ull;
+    long episodes = 0, wins = 0, errors = 0;
+    long long total_score = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t oldest = env.next; // Oldest submitted batch whose observations were not read yet
+    for (long submitted = 0; submitted < batches || oldest != env.next;)
+    {
+        if (submitted < batches && env.next - oldest < (uint32_t)in_flight)
+        {
+            int8_t *actions = maze_env_begin(&env);
+            for (uint32_t i = 0; i < envs; i++)
+                actions[i] = (int8_t)(next_random(&random) % 5);
+            maze_env_submit(&env);
+            submitted++;
+            continue;
+        }
+        maze_env_wait(&env, oldest);
+        const maze_env_obs *obs = maze_env_observations(&env, oldest);
+        for (uint32_t i = 0; i < envs; i++)
+        {
+            int expected_cycle = obs[i].done ? 0 : last[i].cycle + 1;
+            if (obs[i].cycle != expected_cycle || obs[i].vision_rows == 0 || obs[i].vision_rows > MAZE_ENV_VISION_DIM)
+                errors++;
+            if (obs[i].done)
+            {
+                episodes++;
+                wins += obs[i].won;
+                total_score += obs[i].final_score;
+            }
+            last[i] = obs[i];
+        }
+        oldest++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    maze_env_shutdown(&env);
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf("%ld batches of %u games in %.3f s: %.0f batches/s, %.0f steps/s\n", batches, envs, seconds,
+           batches / seconds, batches * (double)envs / seconds);
+    printf("%ld episodes finished (%ld won), mean score %.1f, %ld bad observations\n", episodes, wins,
+           episodes ? (double)total_score / episodes : 0.0, errors);
+    free(last);
+    maze_env_close(&env);
+    return errors ? 1 : 0;
+}
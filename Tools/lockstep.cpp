@@ -0,0 +1,295 @@
+// Lockstep differential check: plays every map on the reference engine
+// (Tools/reference_engine.h) and on the optimised Game side by side, feeding
+// both the same actions, and compares the whole grid, the score, the cycle and
+// the player after every cycle. The optimised engine runs with eager enemies,
+// with lazy enemies, and reset from a map template after a throwaway episode.
+// Actions come from both brain strategies and from seeded random walks, which
+// run into enemies and traps far more often than the brains do. The first
+// divergence of every run is reported with the actions that led to it.
+//
+// Usage: lockstep.out [-walks N] [maps...]   (default: 3 walks, shipped maps and the generated corpus)
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Game/game.h"
+#include "../GameAI/brain.h"
+#include "reference_engine.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// Reaches the private grid and player of Game (declared a friend in game.h)
+struct LockstepProbe
+{
+    static const Grid &grid(const Game &game) { return game.map; }
+    static const Player &player(const Game &game) { return game.player; }
+};
+
+namespace
+{
+    enum class Engine
+    {
+        Eager, // Every enemy stepped every cycle
+        Lazy,  // Far away enemies parked and caught up on demand
+        Reset  // Built from a template, one throwaway episode, then Game::reset()
+    };
+
+    const char *engineName(Engine engine)
+    {
+        switch (engine)
+        {
+        case Engine::Eager:
+            return "eager";
+        case Engine::Lazy:
+            return "lazy";
+        default:
+            return "reset";
+        }
+    }
+
+    // Where the actions come from: a brain strategy, or a random walk with a seed
+    struct Driver
+    {
+        string name;
+        bool random{false};
+        BrainStrategy strategy{BrainStrategy::WorldModel};
+        uint64_t seed{0};
+    };
+
+    class RandomWalk
+    {
+        uint64_t state;
+
+    public:
+        explicit RandomWalk(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+        int next() // Biased towards the right, so walks get past the first stage now and then
+        {
+            state ^= state << 13; // xorshift64
+            state ^= state >> 7;
+            state ^= state << 17;
+            int roll = static_cast<int>(state % 20);
+            return roll < 2 ? 0 : roll < 6 ? 1 : roll < 9 ? 2 : roll < 13 ? 3 : 4;
+        }
+    };
+
+    // First difference between the two engines, empty when they agree
+    string compare(const ReferenceGame &reference, Game &game)
+    {
+        game.syncEnemies(); // Lazy enemies must be exact before the grid is read
+        std::ostringstream out;
+        const Grid &grid = LockstepProbe::grid(game);
+        if (grid.height() != reference.height() || grid.width() != reference.width())
+        {
+            out << "map size " << grid.height() << "x" << grid.width() << ", reference " << reference.height() << "x"
+                << reference.width();
+            return out.str();
+        }
+        for (int h{0}; h < grid.height(); h++)
+        {
+            const char *row = grid.row(h);
+            const vector<char> &expected = reference.row(h);
+            if (!std::equal(expected.begin(), expected.end(), row))
+            {
+                int w = static_cast<int>(std::mismatch(expected.begin(), expected.end(), row).first - expected.begin());
+                out << "cell " << h << "," << w << " is '" << row[w] << "', reference '" << expected[w] << "'";
+                return out.str();
+            }
+        }
+        const Player &player = LockstepProbe::player(game);
+        if (player.getH() != reference.getPlayerH() || player.getW() != reference.getPlayerW() ||
+            player.getDirection() != reference.getPlayerDirection())
+        {
+            out << "player " << player.getH() << "," << player.getW() << " '" << player.getDirection() << "', reference "
+                << reference.getPlayerH() << "," << reference.getPlayerW() << " '" << reference.getPlayerDirection() << "'";
+            return out.str();
+        }
+        if (game.getScore() != reference.getScore())
+            out << "score " << game.getScore() << ", reference " << reference.getScore();
+        else if (game.getCycle() != reference.getCycle())
+            out << "cycle " << game.getCycle() << ", reference " << reference.getCycle();
+        else if (game.isGameWon() != reference.isGameWon() || game.isGameOver() != reference.isGameOver())
+            out << "game over " << game.isGameOver() << " won " << game.isGameWon() << ", reference "
+                << reference.isGameOver() << " won " << reference.isGameWon();
+        return out.str();
+    }
+
+    std::unique_ptr<Game> makeEngine(const string &path, Engine engine)
+    {
+        std::unique_ptr<Game> game;
+        if (engine == Engine::Reset)
+        {
+            game = std::make_unique<Game>(Game::loadTemplate(path));
+            game->setLazyEnemies(true);
+            game->initGame();
+            RandomWalk walk(12345);
+            while (!game->isGameOver())
+                game->advanceGameCycle(walk.next()); // Leaves the grid, the counters and the enemies far from the start
+            game->reset();
+        }
+        else
+        {
+            game = std::make_unique<Game>(path, 0, true);
+            game->setLazyEnemies(engine == Engine::Lazy);
+            game->initGame();
+        }
+        return game;
+    }
+
+    struct RunResult
+    {
+        int cycles{0};
+        int score{0};
+        string divergence; // Empty when the engines agreed on every cycle
+    };
+
+    RunResult runLockstep(const string &path, Engine engine, const Driver &driver)
+    {
+        RunResult result;
+        ReferenceGame reference(path);
+        std::unique_ptr<Game> game = makeEngine(path, engine);
+        Brain brain(driver.strategy);
+        RandomWalk walk(driver.seed);
+        GameState state;
+        std::deque<int> recent; // Last actions, shown with a divergence
+
+        auto diverged = [&](const string &what)
+        {
+            std::ostringstream out;
+            out << "cycle " << reference.getCycle() << ": " << what << " (last actions:";
+            for (int action : recent)
+                out << " " << action;
+            out << ")";
+            result.divergence = out.str();
+        };
+
+        string difference = compare(reference, *game);
+        if (!difference.empty())
+        {
+            diverged(difference); // Before the first move: the loaders disagree
+            return result;
+        }
+
+        while (!reference.isGameOver() && !game->isGameOver())
+        {
+            game->getGameState(state);
+            int action = driver.random ? walk.next() : brain.getNextMove(state);
+            recent.push_back(action);
+            if (recent.size() > 12)
+                recent.pop_front();
+
+            string reference_error, engine_error;
+            try
+            {
+                reference.advanceGameCycle(action);
+            }
+            catch (const std::exception &error)
+            {
+                reference_error = error.what();
+            }
+            try
+            {
+                game->advanceGameCycle(action);
+            }
+            catch (const std::exception &error)
+            {
+                engine_error = error.what();
+            }
+            if (!reference_error.empty() || !engine_error.empty())
+            {
+                if (reference_error != engine_error)
+                    diverged("threw \"" + engine_error + "\", reference threw \"" + reference_error + "\"");
+                break; // Both engines refused the same move: nothing left to compare
+            }
+
+            difference = compare(reference, *game);
+            if (!difference.empty())
+            {
+                diverged(difference);
+                break;
+            }
+        }
+        result.cycles = reference.getCycle();
+        result.score = reference.getScore();
+        return result;
+    }
+
+    vector<string> defaultMaps()
+    {
+        vector<string> maps = {"Maps/L1.map", "Maps/L2.map", "Maps/L3.map"};
+        std::error_code error;
+        vector<string> generated;
+        for (const auto &entry : std::filesystem::directory_iterator("Maps/generated", error))
+        {
+            if (entry.path().extension() == ".map")
+                generated.push_back(entry.path().string());
+        }
+        std::sort(generated.begin(), generated.end());
+        maps.insert(maps.end(), generated.begin(), generated.end());
+        return maps;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int walks{3};
+    vector<string> maps;
+    for (int i{1}; i < argc; i++)
+    {
+        if (string(argv[i]) == "-walks" && i + 1 < argc)
+            walks = std::max(0, std::stoi(argv[++i]));
+        else
+            maps.push_back(argv[i]);
+    }
+    if (maps.empty())
+        maps = defaultMaps();
+
+    vector<Driver> drivers = {{"model", false, BrainStrategy::WorldModel}, {"scripts", false, BrainStrategy::StageScripts}};
+    for (int seed{1}; seed <= walks; seed++)
+        drivers.push_back({"walk " + std::to_string(seed), true, BrainStrategy::WorldModel, static_cast<uint64_t>(seed)});
+
+    int runs{0}, failures{0};
+    cout << std::left << std::setw(36) << "map" << std::setw(8) << "engine" << std::setw(10) << "actions" << std::right
+         << std::setw(8) << "cycles" << std::setw(8) << "score" << "  result" << endl;
+    for (const string &path : maps)
+    {
+        for (Engine engine : {Engine::Eager, Engine::Lazy, Engine::Reset})
+        {
+            for (const Driver &driver : drivers)
+            {
+                RunResult result;
+                try
+                {
+                    result = runLockstep(path, engine, driver);
+                }
+                catch (const std::exception &error)
+                {
+                    result.divergence = string("could not start: ") + error.what();
+                }
+                runs++;
+                failures += !result.divergence.empty();
+                cout << std::left << std::setw(36) << path << std::setw(8) << engineName(engine) << std::setw(10)
+                     << driver.name << std::right << std::setw(8) << result.cycles << std::setw(8) << result.score << "  "
+                     << (result.divergence.empty() ? "same" : "DIVERGED at " + result.divergence) << endl;
+            }
+        }
+    }
+    if (failures)
+    {
+        cout << failures << " of " << runs << " runs diverged from the reference engine" << endl;
+        return 1;
+    }
+    cout << "All " << runs << " runs matched the reference engine" << endl;
+    return 0;
+}
@@ -0,0 +1,328 @@
+#include "map_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    // splitmix64: tiny, fast and identical on every platform (unlike std:: distributions)
+    class Random
+    {
+        uint64_t state;
+
+    public:
+        explicit Random(uint64_t seed) : state(seed) {}
+        uint64_t next()
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+        int range(int low, int high) { return low + static_cast<int>(next() % static_cast<uint64_t>(high - low + 1)); } // [low, high]
+        bool chance(double p) { return (next() >> 11) * 0x1.0p-53 < p; }
+    };
+
+    struct Stage
+    {
+        int first;  // First interior column
+        int last;   // Last interior column
+        int entry;  // Row of the gap/door in the start column (player row for stage 0)
+        int exit;   // Row of the gap/door/goal in the next start column
+        int spine;  // Column of the vertical leg of the guaranteed path
+    };
+}
+
+vector<string> generateMap(const MapGenConfig &config)
+{
+    const int W = config.width;
+    const int H = config.height;
+    const int S = config.stages;
+    if (S < 1 || H < 5 || W < 3)
+        throw std::invalid_argument("Map needs at least one stage, 5 rows and 3 columns");
+
+    // Stage s spans columns [start[s], start[s + 1]); the last column is the right border with the goal
+    vector<int> start(S + 1);
+    for (int s{0}; s <= S; s++)
+    {
+        start[s] = static_cast<int>(static_cast<int64_t>(s) * (W - 1) / S);
+    }
+    for (int s{0}; s < S; s++)
+    {
+        int band = start[s + 1] - start[s];
+        if (band < 4 || band <= static_cast<int>(std::to_string(s + 1).size()))
+            throw std::invalid_argument("Map too narrow for " + std::to_string(S) + " stages");
+    }
+
+    Random random(config.seed);
+    vector<string> grid(H, string(W, ' '));
+    vector<vector<char>> reserved(H, vector<char>(W, false)); // Cells on guaranteed paths
+    for (int h{0}; h < H; h++)
+    {
+        for (int s{0}; s <= S; s++)
+            grid[h][start[s]] = '+'; // Left border, stage boundaries and right border
+    }
+    for (int w{0}; w < W; w++)
+    {
+        grid[0][w] = '+';
+        grid[H - 1][w] = '+';
+    }
+
+    auto carve = [&](int h, int w)
+    {
+        if (grid[h][w] == '+' || grid[h][w] == 'T')
+            grid[h][w] = ' ';
+        reserved[h][w] = true;
+    };
+
+    int entry = random.range(1, H - 2);
+    for (int s{0}; s < S; s++)
+    {
+        Stage stage{start[s] + 1, start[s + 1] - 1, entry, random.range(1, H - 2), 0};
+        stage.spine = random.range(stage.first, stage.last);
+        bool last_stage = (s == S - 1);
+        bool hazards = (s > 0);
+
+        // Random walls, then the spine: along the entry row, down/up the spine column, along the exit row
+        for (int h{1}; h < H - 1; h++)
+        {
+            for (int w = stage.first; w <= stage.last; w++)
+            {
+                if (random.chance(config.wall_density))
+                    grid[h][w] = '+';
+            }
+        }
+        for (int w = stage.first; w <= stage.spine; w++)
+            carve(stage.entry, w);
+        for (int h = std::min(stage.entry, stage.exit); h <= std::max(stage.entry, stage.exit); h++)
+            carve(h, stage.spine);
+        for (int w = stage.spine; w <= stage.last; w++)
+            carve(stage.exit, w);
+        if (s == 0)
+            grid[stage.entry][stage.first] = '>'; // Player start
+
+        // Items hang off the spine through vertical links that never cross a 'B'
+        auto place = [&](char item)
+        {
+            for (int attempt{0}; attempt < 64; attempt++)
+            {
+                int h = random.range(1, H - 2);
+                int w = random.range(stage.first, stage.last);
+                if (reserved[h][w])
+                    continue;
+                int spine_row = (w <= stage.spine) ? stage.entry : stage.exit;
+                int step = (spine_row > h) ? 1 : -1;
+                bool blocked = false;
+                for (int r = h + step; r != spine_row; r += step)
+                    blocked = blocked || grid[r][w] == 'B';
+                if (blocked)
+                    continue;
+                grid[h][w] = item;
+                reserved[h][w] = true;
+                for (int r = h + step; r != spine_row; r += step)
+                    carve(r, w);
+                return true;
+            }
+            return false;
+        };
+
+        int interior = (stage.last - stage.first + 1) * (H - 2);
+        int food = 0;
+        int food_target = static_cast<int>(interior * config.food_density);
+        if (random.chance(interior * config.food_density - food_target))
+            food_target++; // Keep the expected amount exact for low densities
+        for (int i{0}; i < food_target; i++)
+            food += place('0') ? 1 : 0;
+        bool flags = random.chance(config.flag_probability) && place('A') && place('B');
+        bool door = !last_stage && random.chance(config.door_probability);
+        if (door && food == 0 && !flags)
+            door = place('0'); // A door needs something to open it; fall back to a gap
+
+        if (hazards)
+        {
+            for (int h{1}; h < H - 1; h++)
+            {
+                for (int w = stage.first; w <= stage.last; w++)
+                {
+                    if (!reserved[h][w] && grid[h][w] == ' ' && random.chance(config.trap_density))
+                        grid[h][w] = 'T';
+                }
+            }
+            // Enemies only go where they can patrol between two walls over empty cells
+            for (int w = stage.first; w <= stage.last; w++)
+            {
+                for (int h{1}; h < H - 1; h++)
+                {
+                    if (grid[h][w] != ' ' || !random.chance(config.enemy_density))
+                        continue;
+                    int top = h;
+                    while (grid[top - 1][w] == ' ')
+                        top--;
+                    int bottom = h;
+                    while (grid[bottom + 1][w] == ' ')
+                        bottom++;
+                    if (grid[top - 1][w] == '+' && grid[bottom + 1][w] == '+' && bottom > top)
+                    {
+                        grid[h][w] = 'X';
+                        h = bottom + 1; // One enemy per patrol segment
+                    }
+                }
+            }
+        }
+
+        if (last_stage)
+            grid[stage.exit][W - 1] = 'w';
+        else
+            grid[stage.exit][start[s + 1]] = door ? 'D' : ' ';
+        entry = stage.exit;
+    }
+
+    string markers(W, ' ');
+    for (int s{0}; s < S; s++)
+    {
+        string label = std::to_string(s + 1);
+        markers.replace(start[s], label.size(), label);
+    }
+    grid.insert(grid.begin(), markers);
+    return grid;
+}
+
+bool isMapSolvable(const vector<string> &lines, string &reason)
+{
+    if (lines.size() < 2)
+    {
+        reason = "map has no rows";
+        return false;
+    }
+    const int H = lines.size() - 1;
+    const int W = lines[0].size();
+    vector<int> start;
+    for (int w{0}; w < W; w++)
+    {
+        if (isdigit(static_cast<unsigned char>(lines[0][w])) && (w == 0 || !isdigit(static_cast<unsigned char>(lines[0][w - 1]))))
+            start.push_back(w);
+    }
+    if (start.empty())
+    {
+        reason = "no stage markers";
+        return false;
+    }
+    const int S = start.size();
+    vector<int> column_stage(W, -1);
+    for (int s{0}; s < S; s++)
+    {
+        for (int w = start[s]; w < (s + 1 < S ? start[s + 1] : W); w++)
+            column_stage[w] = s;
+    }
+    auto tile = [&](int h, int w)
+    { return lines[h + 1][w]; };
+
+    int player_h = -1, player_w = -1;
+    vector<int> food(S, 0);
+    for (int h{0}; h < H; h++)
+    {
+        for (int w{0}; w < W; w++)
+        {
+            char c = tile(h, w);
+            if (c == 'v' || c == '^' || c == '<' || c == '>')
+            {
+                player_h = h;
+                player_w = w;
+            }
+            else if (c == '0' && column_stage[w] >= 0)
+                food[column_stage[w]]++;
+        }
+    }
+    if (player_h < 0)
+    {
+        reason = "no player";
+        return false;
+    }
+
+    // Grow the reachable area until no more doors open: eating all food of a stage or placing
+    // its 'B' (after reaching an 'A') opens the next closed 'D' in the following start column.
+    vector<int> doors_open(S, 0);
+    vector<char> picked(S, false);
+    bool goal = false;
+    for (bool changed = true; changed && !goal;)
+    {
+        changed = false;
+        vector<char> seen(static_cast<size_t>(H) * W, false);
+        vector<int> eaten(S, 0);
+        vector<char> placed(S, false);
+        std::deque<std::array<int, 2>> queue{{player_h, player_w}};
+        seen[player_h * W + player_w] = true;
+        while (!queue.empty())
+        {
+            auto [h, w] = queue.front();
+            queue.pop_front();
+            const int dh[4] = {-1, 1, 0, 0};
+            const int dw[4] = {0, 0, -1, 1};
+            for (int d{0}; d < 4; d++)
+            {
+                int nh = h + dh[d], nw = w + dw[d];
+                if (nh < 0 || nh >= H || nw < 0 || nw >= W || seen[nh * W + nw] || column_stage[nw] < 0)
+                    continue;
+                char c = tile(nh, nw);
+                int stage = column_stage[nw];
+                if (c == '+' || c == 'T' || (c == 'B' && !picked[stage]))
+                    continue;
+                if (c == 'D')
+                {
+                    // Doors of stage s sit in the start column of stage s + 1 and open top to bottom
+                    int rank = 0;
+                    for (int r{0}; r < nh; r++)
+                        rank += tile(r, nw) == 'D' ? 1 : 0;
+                    if (stage == 0 || rank >= doors_open[stage - 1])
+                        continue;
+                }
+                seen[nh * W + nw] = true;
+                if (c == 'w')
+                {
+                    goal = true;
+                    continue;
+                }
+                if (c == '0')
+                    eaten[stage]++;
+                if (c == 'A' && !picked[stage])
+                {
+                    picked[stage] = true;
+                    changed = true;
+                }
+                if (c == 'B')
+                    placed[stage] = true;
+                queue.push_back({nh, nw});
+            }
+        }
+        for (int s{0}; s + 1 < S; s++)
+        {
+            int triggers = (food[s] > 0 && eaten[s] == food[s] ? 1 : 0) + (placed[s] ? 1 : 0);
+            if (triggers > doors_open[s])
+            {
+                doors_open[s] = triggers;
+                changed = true;
+            }
+        }
+    }
+    if (!goal)
+        reason = "goal 'w' is not reachable";
+    return goal;
+}
+
+void writeMapFile(const vector<string> &lines, const string &path)
+{
+    std::ofstream out(path, std::ios::trunc);
+    for (const auto &line : lines)
+    {
+        out << line << '\n';
+    }
+    if (!out)
+        throw std::runtime_error("Could not write map file: " + path);
+}
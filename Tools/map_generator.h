@@ -0,0 +1,36 @@
+#ifndef MAP_GENERATOR_H
+#define MAP_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct MapGenConfig
+{
+    int width{57};                 // Map width including the border columns
+    int height{10};                // Map height without the marker line, including the border rows
+    int stages{6};                 // Number of stages (bands of columns)
+    uint64_t seed{1};              // Same seed and settings always give the same map
+    double wall_density{0.25};     // Chance that an interior cell starts as a wall '+'
+    double food_density{0.04};     // Food '0' per interior cell
+    double trap_density{0.05};     // Chance that a free cell off the guaranteed paths becomes a trap 'T'
+    double enemy_density{0.03};    // Chance that a free cell with a clean patrol column gets an enemy 'X'
+    double flag_probability{0.3};  // Chance that a stage gets an A/B flag pair
+    double door_probability{0.5};  // Chance that a stage is closed by a door 'D' rather than a gap
+};
+
+// Generates the lines of a .map file (marker line first). Every stage is
+// solvable: food, flags and the exit are connected to the stage entry by paths
+// free of walls, traps and closed doors (enemies patrol across them), and a
+// stage closed by a door always holds food or a flag pair that opens it.
+// Stage 0 holds the player and no hazards, because its start column is the
+// left border and offers no respawn cell. Throws std::invalid_argument on
+// settings that cannot produce a valid map.
+std::vector<std::string> generateMap(const MapGenConfig &config);
+
+// Checks the solvability guarantee above on a generated or hand-written map
+bool isMapSolvable(const std::vector<std::string> &lines, std::string &reason);
+
+void writeMapFile(const std::vector<std::string> &lines, const std::string &path);
+
+#endif // MAP_GENERATOR_H
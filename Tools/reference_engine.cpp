@@ -0,0 +1,249 @@
+#include "reference_engine.h"
+
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+ReferenceGame::ReferenceGame(const string &path_to_map)
+{
+    std::ifstream map_file(path_to_map);
+    if (!map_file.is_open())
+    {
+        throw std::runtime_error("Could not open map file: " + path_to_map);
+    }
+    vector<string> map_lines;
+    string line;
+    while (std::getline(map_file, line))
+    {
+        if (line == "")
+            throw std::runtime_error("Empty line in map file");
+        if (!map_lines.empty() && line.length() != map_lines[0].length())
+            throw std::runtime_error("Inconsistent line length in map file");
+        map_lines.push_back(line);
+    }
+    if (map_lines.empty())
+        throw std::runtime_error("Empty map file: " + path_to_map);
+
+    // The first line holds the stage markers, a run of digits marks one stage
+    const string &markers = map_lines[0];
+    for (size_t i{0}; i < markers.size(); i++)
+    {
+        if (isdigit(static_cast<unsigned char>(markers[i])) && (i == 0 || !isdigit(static_cast<unsigned char>(markers[i - 1]))))
+        {
+            stage_indices.push_back(i);
+        }
+    }
+
+    for (size_t h{1}; h < map_lines.size(); h++)
+    {
+        map.push_back(vector<char>(map_lines[h].begin(), map_lines[h].end()));
+        for (size_t w{0}; w < map_lines[h].size(); w++)
+        {
+            char c = map_lines[h][w];
+            if (c == 'v' || c == '>' || c == '<' || c == '^')
+            {
+                player_h = h - 1; // The last player character wins
+                player_w = w;
+                player_direction = c;
+            }
+            else if (c == '0')
+            {
+                food_count[getStage(w)]++;
+            }
+            else if (c == 'A' || c == 'B')
+            {
+                stage_flag_picked[getStage(w)] = false;
+                stage_flag_placed[getStage(w)] = false;
+            }
+            else if (c == 'X')
+            {
+                enemies.push_back(Enemy{static_cast<int>(h - 1), static_cast<int>(w)});
+            }
+        }
+    }
+}
+
+int ReferenceGame::getStage(int w) const
+{
+    for (size_t i{0}; i < stage_indices.size(); i++)
+    {
+        if (w >= stage_indices[i] && (i + 1 >= stage_indices.size() || w < stage_indices[i + 1]))
+        {
+            return i;
+        }
+    }
+    throw std::runtime_error("Invalid stage index: " + std::to_string(w));
+}
+
+char ReferenceGame::tile(int h, int w) const
+{
+    if (h < 0 || h >= height() || w < 0 || w >= width())
+        return '+';
+    return map[h][w];
+}
+
+void ReferenceGame::advanceGameCycle(int action)
+{
+    if (action == 1 || action == 2 || action == 3 || action == 4)
+    {
+        movePlayer(action);
+    }
+    else if (action != 0)
+    {
+        throw std::runtime_error("Invalid player action: " + std::to_string(action));
+    }
+    if (getStage(player_w) > max_crossed_stage)
+    {
+        max_crossed_stage = getStage(player_w);
+        score += max_crossed_stage * 10;
+    }
+    for (auto &enemy : enemies)
+    {
+        moveEnemy(enemy);
+    }
+    cycle++;
+}
+
+void ReferenceGame::movePlayer(int direction)
+{
+    int h = player_h;
+    int w = player_w;
+    int new_h = h;
+    int new_w = w;
+    switch (direction)
+    {
+    case 1:
+        new_h = h - 1;
+        player_direction = '^';
+        break;
+    case 2:
+        new_w = w - 1;
+        player_direction = '<';
+        break;
+    case 3:
+        new_h = h + 1;
+        player_direction = 'v';
+        break;
+    case 4:
+        new_w = w + 1;
+        player_direction = '>';
+        break;
+    }
+    char target = tile(new_h, new_w);
+    map[h][w] = player_direction; // Turning is visible even when the move is blocked
+    auto step = [&]()
+    {
+        map[h][w] = ' ';
+        map[new_h][new_w] = player_direction;
+        player_h = new_h;
+        player_w = new_w;
+    };
+    if (target == ' ')
+    {
+        step();
+    }
+    else if (target == '0')
+    {
+        step();
+        int stage = getStage(new_w);
+        food_count[stage]--;
+        if (food_count[stage] == 0)
+        {
+            openDoor(stage);
+        }
+        score++;
+    }
+    else if (target == 'A')
+    {
+        int stage = getStage(new_w);
+        if (!stage_flag_picked[stage])
+        {
+            step();
+            stage_flag_picked[stage] = true;
+            score += 10;
+        }
+    }
+    else if (target == 'B' && stage_flag_picked[getStage(new_w)])
+    {
+        step();
+        int stage = getStage(new_w);
+        stage_flag_placed[stage] = true;
+        score += 15;
+        openDoor(stage);
+    }
+    else if (target == 'X' || target == 'T')
+    {
+        map[h][w] = ' ';
+        respawn();
+    }
+    else if (target == 'w')
+    {
+        score += 1000;
+        score += MAX_CYCLE - cycle;
+        game_won = true;
+    }
+    // '+', 'D', a 'B' without the flag and anything else: blocked
+}
+
+void ReferenceGame::moveEnemy(Enemy &enemy)
+{
+    int new_h = enemy.direction == 'v' ? enemy.h + 1 : enemy.h - 1;
+    int new_w = enemy.w;
+    char target = tile(new_h, new_w);
+    if (target == ' ')
+    {
+        map[enemy.h][enemy.w] = ' ';
+        map[new_h][new_w] = 'X';
+        enemy.h = new_h;
+    }
+    else if (target == '+')
+    {
+        enemy.direction = enemy.direction == 'v' ? '^' : 'v';
+    }
+    else if (player_h == new_h && player_w == new_w)
+    {
+        respawn();
+        map[enemy.h][enemy.w] = ' ';
+        map[new_h][new_w] = 'X';
+        enemy.h = new_h;
+    }
+}
+
+void ReferenceGame::respawn()
+{
+    int column = stage_indices[getStage(player_w)];
+    bool respawned = false;
+    for (int i{0}; i < height(); i++)
+    {
+        if (map[i][column] == ' ') // Every empty cell of the column is written, the last one keeps the player
+        {
+            player_direction = '>';
+            map[i][column] = player_direction;
+            player_h = i;
+            player_w = column;
+            respawned = true;
+        }
+    }
+    if (!respawned)
+    {
+        throw std::runtime_error("Invalid respawn position for player");
+    }
+}
+
+void ReferenceGame::openDoor(int stage)
+{
+    if (stage + 1 >= static_cast<int>(stage_indices.size()))
+        return; // The last stage has no door column
+    int w = stage_indices[stage + 1];
+    for (int i{0}; i < height(); i++)
+    {
+        if (map[i][w] == 'D')
+        {
+            map[i][w] = ' ';
+            break;
+        }
+    }
+}
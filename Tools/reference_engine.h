@@ -0,0 +1,65 @@
+#ifndef REFERENCE_ENGINE_H
+#define REFERENCE_ENGINE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Frozen copy of the original game rules, kept as the oracle for Tools/lockstep.cpp.
+// It is deliberately the plain version: a vector of rows, a column scan for every
+// door and respawn, every enemy moved every cycle. Do not optimise it; change it
+// only when the rules themselves change.
+//
+// Two things differ from the first engine, both to match the map format the
+// optimised engine defines: stage markers may have several digits ("12" marks
+// one stage starting at the '1'), and cells outside the map read as '+' instead
+// of the zero-filled row the first loader left below the last line.
+class ReferenceGame
+{
+    struct Enemy
+    {
+        int h;
+        int w;
+        char direction{'v'}; // Every enemy is vertical and starts moving down
+    };
+
+    const int MAX_CYCLE{1000};
+    int score{0};
+    int cycle{0};
+    std::vector<std::vector<char>> map;
+    std::vector<int> stage_indices;                  // First column of every stage
+    std::unordered_map<int, int> food_count;         // Food left per stage
+    std::unordered_map<int, bool> stage_flag_picked; // Flag picked per stage
+    std::unordered_map<int, bool> stage_flag_placed; // Flag placed per stage
+    std::vector<Enemy> enemies;
+    int player_h{-1};
+    int player_w{-1};
+    char player_direction{' '};
+    int max_crossed_stage{0};
+    bool game_won{false};
+
+private:
+    int getStage(int w) const;
+    char tile(int h, int w) const; // '+' outside the map
+    void movePlayer(int direction);
+    void moveEnemy(Enemy &enemy);
+    void respawn();
+    void openDoor(int stage);
+
+public:
+    explicit ReferenceGame(const std::string &path_to_map); // Loads a text map, throws std::runtime_error on bad maps
+    void advanceGameCycle(int action);
+
+    int height() const { return static_cast<int>(map.size()); }
+    int width() const { return map.empty() ? 0 : static_cast<int>(map[0].size()); }
+    const std::vector<char> &row(int h) const { return map[h]; }
+    int getScore() const { return score; }
+    int getCycle() const { return cycle; }
+    int getPlayerH() const { return player_h; }
+    int getPlayerW() const { return player_w; }
+    char getPlayerDirection() const { return player_direction; }
+    bool isGameWon() const { return game_won; }
+    bool isGameOver() const { return cycle > MAX_CYCLE || game_won; }
+};
+
+#endif // REFERENCE_ENGINE_H
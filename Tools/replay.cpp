@@ -0,0 +1,105 @@
+// Replays a recorded episode (see main.cpp -record) at full speed.
+//
+// Usage: replay.out <log.mzr> [-seek N] [-frames A:B] [-nofog]
+//   no option     re-simulate the whole episode, check every keyframe, print the result
+//   -seek N       render the frame of cycle N
+//   -frames A:B   render the frames of cycles A to B
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../Game/game.h"
+#include "../Game/replay.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: " << argv[0] << " <log.mzr> [-seek N] [-frames A:B] [-nofog]" << endl;
+        return 1;
+    }
+    bool render_frames = false; // -seek or -frames given
+    int first_frame = -1;
+    int last_frame = -1;
+    bool fog = true;
+    for (int i{2}; i < argc; i++)
+    {
+        string option = argv[i];
+        if (option == "-seek" && i + 1 < argc)
+        {
+            first_frame = last_frame = std::stoi(argv[++i]);
+            render_frames = true;
+        }
+        else if (option == "-frames" && i + 1 < argc)
+        {
+            string range = argv[++i];
+            size_t colon = range.find(':');
+            first_frame = std::stoi(range.substr(0, colon));
+            last_frame = colon == string::npos ? first_frame : std::stoi(range.substr(colon + 1));
+            render_frames = true;
+        }
+        else if (option == "-nofog")
+        {
+            fog = false;
+        }
+        else
+        {
+            cerr << "Error: unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        ReplayLog log(argv[1]);
+        Game game(log.mapPath(), 0, true);
+        game.initGame();
+        if (game.stateHash() != log.mapHash())
+        {
+            cerr << "Error: " << log.mapPath() << " is not the map this episode was recorded on" << endl;
+            return 1;
+        }
+
+        if (!render_frames)
+        {
+            auto start = std::chrono::steady_clock::now();
+            int mismatch = log.replay(game);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (mismatch >= 0)
+            {
+                cerr << "Error: replay diverges from the recorded keyframe at cycle " << mismatch << endl;
+                return 1;
+            }
+            cout << "Replayed " << log.cycles() << " cycles of " << log.mapPath() << " in " << seconds * 1e3
+                 << " ms, all keyframes match. Final Score: " << game.getScore() << endl;
+            return 0;
+        }
+        if (first_frame < 0 || first_frame > last_frame || last_frame > log.cycles())
+        {
+            cerr << "Error: " << first_frame << ":" << last_frame << " is not a range of recorded cycles (0:" << log.cycles()
+                 << ")" << endl;
+            return 1;
+        }
+        for (int frame = first_frame; frame <= last_frame; frame++)
+        {
+            log.seek(game, frame); // Consecutive frames step forward instead of reloading a keyframe
+            cout << "Cycle " << frame;
+            if (frame < log.cycles())
+                cout << " (next action " << log.actionAt(frame) << ")";
+            cout << endl;
+            game.renderFrame(cout, fog);
+        }
+    }
+    catch (const std::exception &error)
+    {
+        cerr << "Error: " << error.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,19 +1,74 @@
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Game/game.h"
+#include "Game/input.h"
+#include "Game/replay.h"
+#include "Game/tracer.h"
 #include "GameAI/brain.h"
-#include "manual_interface.h"
+#include "Runner/env_server.h"
+#include "Runner/tournament.h"
 
 using std::cout;
 using std::endl;
 using std::string;
+using std::vector;
+
+// A terminal that stopped taking frames is reported, the game itself already ran to the end
+static void stopRendering(Game &game)
+{
+    try
+    {
+        game.stopRendering();
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << "Error: " << error.what() << std::endl;
+    }
+}
+
+// Reads the value of a numeric flag, which must be a whole number of at least `minimum` (0 or 1)
+static bool parseNumber(const string &flag, const string &text, int minimum, int &value)
+{
+    try
+    {
+        size_t used{0};
+        int parsed = std::stoi(text, &used);
+        if (used == text.size() && parsed >= minimum)
+        {
+            value = parsed;
+            return true;
+        }
+    }
+    catch (const std::exception &)
+    {
+        // Not a number, or out of range: reported below like a too small value
+    }
+    std::cerr << "Error: " << flag << " expects a " << (minimum > 0 ? "positive" : "non-negative") << " number." << std::endl;
+    return false;
+}
 
 int main(int argc, char **argv)
 {
     string path_to_map = "Maps/L1.map"; // Path to the defaukl map file
     int visual = 0;                     // Flag for visual mode (0 = no visual)
     bool human = false;
+    int ticks_per_second = 0;           // Real-time human play: cycles per second (0 = wait for every key)
+    BrainStrategy strategy = BrainStrategy::WorldModel; // How the AI picks its moves
+    bool tournament = false;            // Headless parallel runner mode
+    TournamentConfig tournament_config; // Settings for the headless runner
+    EnvServerConfig env_config;         // Settings of the shared-memory environment server (empty name = off)
+    string record_path;                 // Replay log to write (empty = no recording)
+    int keyframe_interval = 100;        // Cycles between full-state keyframes in the replay log
+    int fps = 0;                        // Frames per second in the visual modes (0 = mode default)
+    bool profile = false;               // Collect per-call latency histograms
+    string profile_path;                // File for the latency summary (empty = print it)
+    string trace_path;                  // File for the span trace (empty = no tracing)
 
     for (int i{1}; i < argc; i++)
     {
@@ -22,6 +77,7 @@ int main(int argc, char **argv)
             if (i + 1 < argc && argv[i + 1][0] != '-')
             {
                 path_to_map = string(argv[i + 1]); // Get the map file path from command line argument
+                tournament_config.maps.push_back(path_to_map);
                 i++;
             }
             else
@@ -44,33 +100,200 @@ int main(int argc, char **argv)
             visual = 3; // no delay visual and no fog
             human = true;
         }
+        else if (string(argv[i]) == "-realtime")
+        {
+            visual = visual ? visual : 2; // the game keeps moving while the human thinks
+            human = true;
+            ticks_per_second = 5;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                if (!parseNumber(argv[i], argv[i + 1], 1, ticks_per_second))
+                    return 1; // cycles per second
+                i++;
+            }
+        }
         else if (string(argv[i]) == "-testvisual")
         {
             visual = 4; // visual with delay and no fog
         }
+        else if (string(argv[i]) == "-scripted")
+        {
+            strategy = BrainStrategy::StageScripts; // the original per-stage state machines
+        }
+        else if (string(argv[i]) == "-tournament")
+        {
+            tournament = true; // many headless episodes on a thread pool
+        }
+        else if (string(argv[i]) == "-campaign")
+        {
+            tournament = true; // a tournament whose consecutive episodes cycle through the maps
+            tournament_config.campaign = true;
+        }
+        else if (string(argv[i]) == "-env" && i + 1 < argc)
+        {
+            env_config.name = argv[i + 1]; // serve batched games to an external trainer through shared memory
+            i++;
+        }
+        else if (string(argv[i]) == "-record" && i + 1 < argc)
+        {
+            record_path = argv[i + 1]; // record a replay log of this episode
+            i++;
+        }
+        else if (string(argv[i]) == "-keyframe" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[i], argv[i + 1], 1, keyframe_interval))
+                return 1;
+            i++;
+        }
+        else if (string(argv[i]) == "-profile")
+        {
+            profile = true; // latency histograms, printed at game over or written to the next argument
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                profile_path = argv[i + 1];
+                i++;
+            }
+        }
+        else if (string(argv[i]) == "-trace" && i + 1 < argc)
+        {
+            trace_path = argv[i + 1]; // Chrome trace-event JSON of every span, written at exit
+            i++;
+        }
+        else if (string(argv[i]) == "-fps" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[i], argv[i + 1], 1, fps))
+                return 1; // render rate of the visual modes
+            i++;
+        }
+        else if ((string(argv[i]) == "-envs" || string(argv[i]) == "-slots") && i + 1 < argc)
+        {
+            int value{0};
+            if (!parseNumber(argv[i], argv[i + 1], 1, value))
+                return 1;
+            if (string(argv[i]) == "-envs")
+                env_config.envs = value;
+            else
+                env_config.ring_slots = value;
+            i++;
+        }
+        else if ((string(argv[i]) == "-episodes" || string(argv[i]) == "-threads") && i + 1 < argc)
+        {
+            int value{0};
+            if (!parseNumber(argv[i], argv[i + 1], 0, value))
+                return 1;
+            if (string(argv[i]) == "-episodes")
+                tournament_config.episodes_per_map = value;
+            else
+                tournament_config.threads = value;
+            i++;
+        }
+    }
+
+    if (!trace_path.empty())
+    {
+        Tracer::start(trace_path); // Before any game exists, so loading the map is traced too
+    }
+
+    if (tournament)
+    {
+        if (tournament_config.maps.empty())
+        {
+            tournament_config.maps = {"Maps/L1.map", "Maps/L2.map", "Maps/L3.map"};
+        }
+        double elapsed_seconds{0};
+        vector<MapSummary> summaries = runTournament(tournament_config, elapsed_seconds);
+        printTournamentSummary(cout, summaries, elapsed_seconds);
+        return 0;
+    }
+
+    if (!env_config.name.empty())
+    {
+        env_config.map = path_to_map;
+        env_config.threads = tournament_config.threads ? tournament_config.threads : 1;
+        EnvServer server(env_config);
+        cout << "Serving " << env_config.envs << " games of " << path_to_map << " on " << env_config.name << endl;
+        uint64_t batches = server.run();
+        cout << "Client shut down the server after " << batches << " batches" << endl;
+        return 0;
     }
 
     // Ensure that the student functions match expectations
     Game game = Game(path_to_map, visual); // Create a new game object
-    Brain brain = Brain();                 // Create a new brain object
+    Brain brain = Brain(strategy);         // Create a new brain object
 
-    game.initGame(); // Start the game
+    game.setFrameRate(fps);
+    std::unique_ptr<Profiler> profiler; // Only exists when profiling, so the disabled hooks see null
+    if (profile)
+    {
+        profiler = std::make_unique<Profiler>();
+        game.setProfiler(profiler.get());
+    }
+    try
+    {
+        game.initGame(); // Start the game
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << "Error: " << error.what() << std::endl; // Missing or malformed map
+        return 1;
+    }
+    ReplayRecorder recorder(path_to_map, keyframe_interval);
 
+    std::unique_ptr<KeyboardInput> keyboard; // Raw mode for the whole session, only when a human plays
+    if (human)
+    {
+        keyboard = std::make_unique<KeyboardInput>();
+    }
+    const auto tick = std::chrono::microseconds(ticks_per_second ? 1000000 / ticks_per_second : 0);
+    auto next_tick = std::chrono::steady_clock::now() + tick;
+
+    GameState game_state;      // Reused every cycle, filled in place
     while (!game.isGameOver()) // Loop until the game is over
     {
-        GameState game_state = game.getGameState(); // Get the current game state
+        game.getGameState(game_state); // Get the current game state
 
         int action;
         if (human)
         {
-            action = getAction();
+            if (ticks_per_second)
+            {
+                std::this_thread::sleep_until(next_tick); // Fixed rate: a cycle without a pending key stays put
+                next_tick += tick;
+                action = keyboard->nextAction();
+            }
+            else
+            {
+                action = keyboard->waitAction();
+            }
+            if (action == KeyboardInput::QUIT)
+            {
+                stopRendering(game);
+                keyboard.reset(); // Back to the normal terminal before printing
+                if (!record_path.empty())
+                {
+                    recorder.save(record_path); // The cycles played so far replay like a finished episode
+                }
+                cout << "Game manually exited." << endl;
+                return 0;
+            }
         }
         else
         {
+            ProfileScope scope(profiler.get(), ProfilePoint::GET_NEXT_MOVE, game_state.stage);
             action = brain.getNextMove(game_state); // Get the next move from the AI brain
         }
+        if (!record_path.empty())
+        {
+            recorder.record(game, action);
+        }
         game.advanceGameCycle(action); // Advance the game by one cycle
     }
+    stopRendering(game); // Show the final frame before the summary
+    keyboard.reset();
+    if (!record_path.empty())
+    {
+        recorder.save(record_path);
+    }
 
     cout << "======================================================\nGame Over! \n";
     cout << "Final Score: " << game.getScore() << endl; // Display the final score
@@ -87,5 +310,20 @@ int main(int argc, char **argv)
         cout << "Nice try. Maybe you'll get it next time." << endl; // Display game won message
     }
     cout << "\n";
+
+    if (profiler && profile_path.empty())
+    {
+        profiler->report(cout);
+    }
+    else if (profiler)
+    {
+        std::ofstream out(profile_path);
+        profiler->report(out);
+        if (!out)
+        {
+            std::cerr << "Error: could not write the profile to " << profile_path << std::endl;
+            return 1;
+        }
+    }
     return 0;
 }
\ No newline at end of file